@@ -0,0 +1,30 @@
+// Allocation churn: 1M short-lived arrays of 8 to 64 ints and 1M small strings
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long long churn_one(long long i)
+{
+    size_t len = 8 + (size_t)(i % 57);
+    long long *arr = malloc(len * sizeof(long long));
+    for (size_t j = 0; j < len; j++)
+        arr[j] = i;
+    char *s = malloc(32);
+    snprintf(s, 32, "%lld-churn", i);
+    long long sum = 0;
+    for (size_t j = 0; j < len; j++)
+        sum += arr[j];
+    sum += (long long)strlen(s);
+    free(arr);
+    free(s);
+    return sum;
+}
+
+int main(void)
+{
+    long long total = 0;
+    for (long long i = 0; i < 1000000; i++)
+        total += churn_one(i);
+    printf("Checksum: %lld\n", total);
+    return 0;
+}
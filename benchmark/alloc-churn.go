@@ -0,0 +1,28 @@
+package main
+
+import (
+	"fmt"
+	"strconv"
+)
+
+//go:noinline
+func churnOne(i int64) int64 {
+	arr := make([]int64, 8+i%57)
+	for j := range arr {
+		arr[j] = i
+	}
+	s := strconv.FormatInt(i, 10) + "-churn"
+	var sum int64
+	for _, v := range arr {
+		sum += v
+	}
+	return sum + int64(len(s))
+}
+
+func main() {
+	var total int64
+	for i := int64(0); i < 1_000_000; i++ {
+		total += churnOne(i)
+	}
+	fmt.Printf("Checksum: %d\n", total)
+}
@@ -0,0 +1,10 @@
+fn churn_one(i: i64) -> i64 {
+    let arr = vec![i; 8 + (i % 57) as usize];
+    let s = i.to_string() + "-churn";
+    arr.iter().sum::<i64>() + s.len() as i64
+}
+
+fn main() {
+    let total: i64 = (0..1_000_000).map(churn_one).sum();
+    println!("Checksum: {}", total);
+}
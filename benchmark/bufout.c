@@ -0,0 +1,11 @@
+// Buffer output throughput: 5M "row N" lines through a fully buffered stdout
+#include <stdio.h>
+
+int main(void)
+{
+    static char buf[1 << 16];
+    setvbuf(stdout, buf, _IOFBF, sizeof buf);
+    for (long long i = 0; i < 5000000; i++)
+        printf("row %lld\n", i);
+    return 0;
+}
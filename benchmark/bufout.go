@@ -0,0 +1,19 @@
+package main
+
+import (
+	"bufio"
+	"os"
+	"strconv"
+)
+
+func main() {
+	w := bufio.NewWriterSize(os.Stdout, 1<<16)
+	var num []byte
+	for i := int64(0); i < 5_000_000; i++ {
+		w.WriteString("row ")
+		num = strconv.AppendInt(num[:0], i, 10)
+		w.Write(num)
+		w.WriteByte('\n')
+	}
+	w.Flush()
+}
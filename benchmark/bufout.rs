@@ -0,0 +1,10 @@
+use std::io::{BufWriter, Write};
+
+fn main() {
+    let stdout = std::io::stdout();
+    let mut w = BufWriter::with_capacity(1 << 16, stdout.lock());
+    for i in 0..5_000_000i64 {
+        writeln!(w, "row {}", i).unwrap();
+    }
+    w.flush().unwrap();
+}
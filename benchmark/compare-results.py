@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Compare hyperfine JSON results against the previous dated run and flag regressions.
+
+Each results/<date>/<bench>.json of the current run is matched with the same file in
+the baseline run, and commands are matched by name. A command regresses when its mean
+time grows by more than --threshold (a fraction) and the growth is also larger than
+twice the combined standard deviation, so noisy runs do not trip the gate on their own.
+Improvements are listed the same way.
+
+By default the current run is the newest directory under results/ and the baseline is
+the newest older one that shares a benchmark with it. Exits with status 1 when any
+command regresses.
+
+    python3 compare-results.py --threshold 0.05
+    python3 compare-results.py --baseline results/2026-02-07 --current results/2026-03-14
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+
+DATE_DIR = re.compile(r"^\d{4}-\d{2}-\d{2}$")
+
+
+def dated_dirs(root):
+    names = sorted(n for n in os.listdir(root) if DATE_DIR.match(n))
+    return [os.path.join(root, n) for n in names if os.path.isdir(os.path.join(root, n))]
+
+
+def benchmarks(run_dir):
+    return {n[: -len(".json")] for n in os.listdir(run_dir) if n.endswith(".json")}
+
+
+def load(path):
+    with open(path) as f:
+        return {r["command"]: r for r in json.load(f)["results"]}
+
+
+def pick_runs(args):
+    runs = dated_dirs(args.results)
+    current = args.current or (runs[-1] if runs else None)
+    if not current:
+        sys.exit(f"no dated result directories under {args.results}")
+    baseline = args.baseline
+    if not baseline:
+        older = [r for r in runs if os.path.basename(r) < os.path.basename(current)]
+        shared = [r for r in older if benchmarks(r) & benchmarks(current)]
+        if not shared:
+            sys.exit(f"no earlier run shares a benchmark with {current}")
+        baseline = shared[-1]
+    return baseline, current
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--results", default="results")
+    parser.add_argument("--baseline", help="baseline run directory")
+    parser.add_argument("--current", help="current run directory")
+    parser.add_argument("--threshold", type=float, default=0.10)
+    args = parser.parse_args()
+
+    baseline, current = pick_runs(args)
+    print(f"Baseline: {baseline}")
+    print(f"Current:  {current}")
+    print(f"Threshold: {args.threshold:.0%}\n")
+    print("| Benchmark | Command | Baseline [ms] | Current [ms] | Change | Status |")
+    print("|:---|:---|---:|---:|---:|:---|")
+
+    regressions = 0
+    for bench in sorted(benchmarks(current) & benchmarks(baseline)):
+        old = load(os.path.join(baseline, bench + ".json"))
+        new = load(os.path.join(current, bench + ".json"))
+        for command in sorted(old.keys() & new.keys()):
+            a, b = old[command], new[command]
+            if a["mean"] <= 0:
+                continue
+            change = b["mean"] / a["mean"] - 1
+            noise = 2 * math.hypot(a.get("stddev") or 0.0, b.get("stddev") or 0.0)
+            status = "ok"
+            if abs(b["mean"] - a["mean"]) > noise:
+                if change > args.threshold:
+                    status = "REGRESSION"
+                    regressions += 1
+                elif change < -args.threshold:
+                    status = "improved"
+            print(
+                f"| {bench} | `{command}` | {a['mean'] * 1e3:.2f} ± {(a.get('stddev') or 0) * 1e3:.2f}"
+                f" | {b['mean'] * 1e3:.2f} ± {(b.get('stddev') or 0) * 1e3:.2f}"
+                f" | {change:+.1%} | {status} |"
+            )
+
+    only_new = sorted(benchmarks(current) - benchmarks(baseline))
+    if only_new:
+        print(f"\nNo baseline for: {', '.join(only_new)}")
+    if regressions:
+        print(f"\n{regressions} regression(s) above {args.threshold:.0%}")
+        sys.exit(1)
+    print("\nNo regressions")
+
+
+if __name__ == "__main__":
+    main()
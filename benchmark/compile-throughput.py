@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Compiler throughput: source lines per second through parse, semantic and codegen.
+
+Generates synthetic MML modules of a few sizes, compiles each to LLVM IR with
+`mmlc ir --profile-out`, and reads the wall time of the ingest (parse), semantic and
+codegen stages from the profile. Clang and the linker are not involved.
+
+With --export-json the results are written in hyperfine's JSON shape (one entry per
+stage and size, times in seconds), so compare-results.py gates them like the runtime
+benchmarks.
+
+    python3 compile-throughput.py -b build/throughput --runs 5 --sizes 500,2000,8000
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+# Profile stage name -> label in the report
+STAGES = [("ingest", "parse"), ("semantic", "semantic"), ("codegen", "codegen")]
+
+
+def generate(functions):
+    """An MML module with `functions` numeric functions and one string helper per ten."""
+    out = ["// Generated by compile-throughput.py; do not edit", ""]
+    for i in range(functions):
+        step = f"f{i - 1} (a - 1)" if i > 0 else "a + 1"
+        out += [
+            f"fn f{i}(x: Int): Int =",
+            f"  let a = x * {i % 7 + 1} + {i};",
+            "  if a % 3 == 0 then a / 3",
+            f"  else {step}",
+            "  end",
+            ";",
+            "",
+        ]
+        if i % 10 == 0:
+            out += [f'fn s{i}(n: Int): String = "v" ++ (int_to_str (n + {i}));', ""]
+    out += [
+        "pub fn main(): Unit =",
+        f"  println ((s0 1) ++ (int_to_str (f{functions - 1} 1)))",
+        ";",
+    ]
+    return "\n".join(out) + "\n"
+
+
+def stage_seconds(profile_path):
+    with open(profile_path) as f:
+        profile = json.load(f)
+    if not profile.get("succeeded", False):
+        sys.exit(f"mmlc reported errors; see {profile_path}")
+    totals = {stage: 0.0 for stage, _ in STAGES}
+    for phase in profile["phases"]:
+        if phase["stage"] in totals:
+            totals[phase["stage"]] += phase["wallNanos"] / 1e9
+    return totals
+
+
+def summary(command, times, lines):
+    mean = statistics.fmean(times)
+    return {
+        "command": command,
+        "mean": mean,
+        "stddev": statistics.stdev(times) if len(times) > 1 else 0.0,
+        "median": statistics.median(times),
+        "min": min(times),
+        "max": max(times),
+        "times": times,
+        "lines": lines,
+        "lines_per_sec": lines / mean if mean > 0 else 0.0,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-b", "--build-dir", default="build/throughput")
+    parser.add_argument("--mmlc", default="mmlc")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--sizes", default="500,2000,8000", help="function counts")
+    parser.add_argument("--export-json", help="write hyperfine-style results here")
+    args = parser.parse_args()
+
+    os.makedirs(args.build_dir, exist_ok=True)
+    results = []
+    print("| Stage | Lines | Mean [ms] | Lines/sec |")
+    print("|:---|---:|---:|---:|")
+    for functions in (int(s) for s in args.sizes.split(",")):
+        source = generate(functions)
+        lines = source.count("\n")
+        src = os.path.join(args.build_dir, f"throughput-{functions}.mml")
+        profile = os.path.join(args.build_dir, f"throughput-{functions}.json")
+        with open(src, "w") as f:
+            f.write(source)
+
+        per_stage = {stage: [] for stage, _ in STAGES}
+        wall = []
+        for _ in range(args.runs):
+            start = time.perf_counter()
+            subprocess.run(
+                [args.mmlc, "ir", "-b", args.build_dir, "--profile-out", profile, src],
+                check=True,
+                stdout=subprocess.DEVNULL,
+            )
+            wall.append(time.perf_counter() - start)
+            for stage, seconds in stage_seconds(profile).items():
+                per_stage[stage].append(seconds)
+
+        rows = [(label, per_stage[stage]) for stage, label in STAGES]
+        # Includes JVM startup, which dominates small modules.
+        rows.append(("mmlc ir", wall))
+        for label, times in rows:
+            result = summary(f"{label} {lines} lines", times, lines)
+            results.append(result)
+            print(
+                f"| {label} | {lines} | {result['mean'] * 1e3:.1f} ± {result['stddev'] * 1e3:.1f}"
+                f" | {result['lines_per_sec']:,.0f} |"
+            )
+
+    if args.export_json:
+        with open(args.export_json, "w") as f:
+            json.dump({"results": results}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,42 @@
+// Concat chains: 1M short labels built from four concatenations each
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *concat(const char *a, const char *b)
+{
+    size_t la = strlen(a), lb = strlen(b);
+    char *s = malloc(la + lb + 1);
+    memcpy(s, a, la);
+    memcpy(s + la, b, lb + 1);
+    return s;
+}
+
+static char *int_to_str(long long v)
+{
+    char buf[24];
+    snprintf(buf, sizeof buf, "%lld", v);
+    return strdup(buf);
+}
+
+// "item-" ++ (i ++ ("-" ++ (i * 7 ++ ";"))), freeing each temporary like MML does
+static size_t label_len(long long i)
+{
+    char *a = int_to_str(i), *b = int_to_str(i * 7);
+    char *t1 = concat(b, ";");
+    char *t2 = concat("-", t1);
+    char *t3 = concat(a, t2);
+    char *s = concat("item-", t3);
+    size_t len = strlen(s);
+    free(a), free(b), free(t1), free(t2), free(t3), free(s);
+    return len;
+}
+
+int main(void)
+{
+    size_t total = 0;
+    for (long long i = 0; i < 1000000; i++)
+        total += label_len(i);
+    printf("Total length: %zu\n", total);
+    return 0;
+}
@@ -0,0 +1,18 @@
+package main
+
+import (
+	"fmt"
+	"strconv"
+)
+
+func label(i int64) string {
+	return "item-" + strconv.FormatInt(i, 10) + "-" + strconv.FormatInt(i*7, 10) + ";"
+}
+
+func main() {
+	total := 0
+	for i := int64(0); i < 1_000_000; i++ {
+		total += len(label(i))
+	}
+	fmt.Printf("Total length: %d\n", total)
+}
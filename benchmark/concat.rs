@@ -0,0 +1,11 @@
+fn label(i: i64) -> String {
+    "item-".to_string() + &i.to_string() + "-" + &(i * 7).to_string() + ";"
+}
+
+fn main() {
+    let mut total = 0;
+    for i in 0..1_000_000i64 {
+        total += label(i).len();
+    }
+    println!("Total length: {}", total);
+}
@@ -0,0 +1,38 @@
+package main
+
+import (
+	"fmt"
+	"strconv"
+)
+
+func nextRand(x int64) int64 {
+	return (x*1103515245 + 12345) % 2147483648
+}
+
+func main() {
+	const n = 1_000_000
+
+	ints := make(map[int64]int64)
+	for i, x := 0, int64(42); i < n; i, x = i+1, nextRand(x) {
+		ints[x%500000]++
+	}
+	var intHits int64
+	for i, x := 0, int64(7); i < n; i, x = i+1, nextRand(x) {
+		intHits += ints[x%1000000]
+	}
+
+	words := make(map[string]int64)
+	seen := make(map[string]struct{})
+	for i, x := 0, int64(42); i < n; i, x = i+1, nextRand(x) {
+		key := "key-" + strconv.FormatInt(x%200000, 10)
+		words[key]++
+		seen[key] = struct{}{}
+	}
+	var wordHits int64
+	for i, x := 0, int64(7); i < n; i, x = i+1, nextRand(x) {
+		wordHits += words["key-"+strconv.FormatInt(x%400000, 10)]
+	}
+
+	fmt.Printf("Int keys: %d, hits: %d\n", len(ints), intHits)
+	fmt.Printf("String keys: %d, hits: %d\n", len(seen), wordHits)
+}
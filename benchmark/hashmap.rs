@@ -0,0 +1,43 @@
+// std HashMap is a SwissTable (hashbrown) with SipHash-1-3 keys.
+use std::collections::{HashMap, HashSet};
+
+fn next_rand(x: i64) -> i64 {
+    (x * 1103515245 + 12345) % 2147483648
+}
+
+fn main() {
+    let n = 1_000_000;
+
+    let mut ints: HashMap<i64, i64> = HashMap::new();
+    let mut x: i64 = 42;
+    for _ in 0..n {
+        *ints.entry(x % 500000).or_insert(0) += 1;
+        x = next_rand(x);
+    }
+    let mut int_hits: i64 = 0;
+    x = 7;
+    for _ in 0..n {
+        int_hits += ints.get(&(x % 1000000)).copied().unwrap_or(0);
+        x = next_rand(x);
+    }
+
+    let mut words: HashMap<String, i64> = HashMap::new();
+    let mut seen: HashSet<String> = HashSet::new();
+    x = 42;
+    for _ in 0..n {
+        let key = format!("key-{}", x % 200000);
+        *words.entry(key.clone()).or_insert(0) += 1;
+        seen.insert(key);
+        x = next_rand(x);
+    }
+    let mut word_hits: i64 = 0;
+    x = 7;
+    for _ in 0..n {
+        let key = format!("key-{}", x % 400000);
+        word_hits += words.get(&key).copied().unwrap_or(0);
+        x = next_rand(x);
+    }
+
+    println!("Int keys: {}, hits: {}", ints.len(), int_hits);
+    println!("String keys: {}, hits: {}", seen.len(), word_hits);
+}
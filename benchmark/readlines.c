@@ -0,0 +1,18 @@
+// Line reading: parse and sum every line of stdin
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(void)
+{
+    char *line = NULL;
+    size_t cap = 0;
+    long long n = 0, total = 0;
+    while (getline(&line, &cap, stdin) >= 0)
+    {
+        n++;
+        total += strtoll(line, NULL, 10);
+    }
+    free(line);
+    printf("Lines: %lld, sum: %lld\n", n, total);
+    return 0;
+}
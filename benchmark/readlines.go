@@ -0,0 +1,19 @@
+package main
+
+import (
+	"bufio"
+	"fmt"
+	"os"
+	"strconv"
+)
+
+func main() {
+	sc := bufio.NewScanner(os.Stdin)
+	var n, total int64
+	for sc.Scan() {
+		v, _ := strconv.ParseInt(sc.Text(), 10, 64)
+		n++
+		total += v
+	}
+	fmt.Printf("Lines: %d, sum: %d\n", n, total)
+}
@@ -0,0 +1,11 @@
+use std::io::BufRead;
+
+fn main() {
+    let stdin = std::io::stdin();
+    let (mut n, mut total) = (0i64, 0i64);
+    for line in stdin.lock().lines() {
+        n += 1;
+        total += line.unwrap().parse::<i64>().unwrap_or(0);
+    }
+    println!("Lines: {}, sum: {}", n, total);
+}
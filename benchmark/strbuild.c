@@ -0,0 +1,27 @@
+// String building: append 1M decimal numbers and commas to one growing buffer
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(void)
+{
+    size_t cap = 16, len = 0;
+    char *buf = malloc(cap);
+    char num[24];
+    for (long long i = 0; i < 1000000; i++)
+    {
+        int n = snprintf(num, sizeof num, "%lld,", i);
+        if (len + (size_t)n >= cap)
+        {
+            while (len + (size_t)n >= cap)
+                cap *= 2;
+            buf = realloc(buf, cap);
+        }
+        memcpy(buf + len, num, (size_t)n);
+        len += (size_t)n;
+    }
+    buf[len] = '\0';
+    printf("Length: %zu\n", len);
+    free(buf);
+    return 0;
+}
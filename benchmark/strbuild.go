@@ -0,0 +1,17 @@
+package main
+
+import (
+	"fmt"
+	"strconv"
+	"strings"
+)
+
+func main() {
+	var sb strings.Builder
+	for i := 0; i < 1_000_000; i++ {
+		sb.WriteString(strconv.Itoa(i))
+		sb.WriteByte(',')
+	}
+	s := sb.String()
+	fmt.Printf("Length: %d\n", len(s))
+}
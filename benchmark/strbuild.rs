@@ -0,0 +1,8 @@
+fn main() {
+    let mut s = String::new();
+    for i in 0..1_000_000i64 {
+        s.push_str(&i.to_string());
+        s.push(',');
+    }
+    println!("Length: {}", s.len());
+}
@@ -1,17 +1,49 @@
+// Expose POSIX/BSD extensions (mmap flags, madvise) under -std=c17 on glibc.
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #if defined(__clang__) || defined(__GNUC__)
 #define FORCE_INLINE __attribute__((always_inline))
+#define MML_COLD_TRAP __attribute__((cold, noreturn, noinline))
+#define MML_UNLIKELY(x) __builtin_expect(!!(x), 0)
 #else
 #define FORCE_INLINE
+#define MML_COLD_TRAP
+#define MML_UNLIKELY(x) (x)
+#endif
+
+// initial-exec TLS skips the __tls_get_addr call, but a shared object using it can fail to
+// dlopen once the static TLS block is full. The runtime is built with -fPIC, so there it keeps
+// the default model; when it ends up in an executable the linker relaxes that to local-exec.
+#if (defined(__clang__) || defined(__GNUC__)) && !defined(__PIC__)
+#define MML_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define MML_TLS_MODEL
 #endif
 
 static void mml_sys_oom_abort(void)
@@ -20,813 +52,4465 @@ static void mml_sys_oom_abort(void)
     abort();
 }
 
-// --- String Struct ---
-typedef struct String
-{
-    size_t length;
-    char *data;
-} String;
+// --- Thread Exit ---
+// Some runtime state belongs to the thread that created it: the region arena, the string
+// pool free lists and the stdout buffer. One pthread key destructor releases all of it when the thread
+// exits. A thread attaches the first time it keeps such state; the main thread never runs
+// the destructor, and its state goes with the process.
 
-// --- Array Structs ---
-typedef struct IntArray
-{
-    int64_t length;
-    int64_t *data;
-} IntArray;
+static void mml_thread_exit(void *arg); // defined after the stdout buffer
+static pthread_key_t mml_thread_key;
+static pthread_once_t mml_thread_once = PTHREAD_ONCE_INIT;
+static _Thread_local int mml_thread_attached;
 
-typedef struct StringArray
+static void mml_thread_key_init(void)
 {
-    int64_t length;
-    String *data;
-} StringArray;
+    pthread_key_create(&mml_thread_key, mml_thread_exit);
+}
 
-typedef struct FloatArray
+// The destructor runs for any non-null value, so the flag's address serves as one.
+__attribute__((noinline)) static void mml_thread_attach_slow(void)
 {
-    int64_t length;
-    float *data;
-} FloatArray;
+    pthread_once(&mml_thread_once, mml_thread_key_init);
+    pthread_setspecific(mml_thread_key, &mml_thread_attached);
+    mml_thread_attached = 1;
+}
 
-// --- Output Buffer ---
-typedef struct
+static inline void mml_thread_attach(void)
 {
-    size_t capacity;
-    size_t length;
-    char *data;
-    int fd;
-} BufferImpl;
-
-typedef BufferImpl *Buffer;
-
-
+    if (MML_UNLIKELY(!mml_thread_attached))
+        mml_thread_attach_slow();
+}
 
-Buffer mkBuffer()
+// --- Region Arena ---
+// While a region opened with mml_arena_push is active, runtime heap allocations are
+// bump-allocated from one reserved address range and released together by the matching
+// mml_arena_pop. The compiler still emits every __free_* call; for arena memory those
+// calls are no-ops, recognised by a single range check. Allocations that do not fit in
+// the reservation fall back to malloc and are freed normally.
+// Values allocated inside a region must not be used after the region is popped.
+// Regions are per thread: each thread that opens one reserves its own range, and the
+// owner check only recognises the calling thread's range, so a value allocated in a
+// region must be freed on the thread that allocated it. Task pool workers run runtime
+// kernels only and never open a region.
+
+#define MML_ARENA_RESERVE ((size_t)4 << 30)
+#define MML_ARENA_RETAIN ((size_t)8 << 20)
+#define MML_ARENA_MAX_DEPTH 64
+#define MML_ALLOC_ALIGN 16
+
+static _Thread_local char *arena_base = NULL;
+static _Thread_local char *arena_top = NULL;
+static _Thread_local char *arena_end = NULL;
+static _Thread_local char *arena_high = NULL;
+static _Thread_local char *arena_marks[MML_ARENA_MAX_DEPTH];
+static _Thread_local int64_t arena_depth = 0;
+static _Thread_local int arena_unavailable = 0;
+
+static int mml_arena_init(void)
 {
-    Buffer b = (Buffer)malloc(sizeof(BufferImpl));
-    if (!b)
-        mml_sys_oom_abort();
-    b->capacity = 1024*8;
-    b->length = 0;
-    b->fd = STDOUT_FILENO;
-    b->data = (char *)malloc(b->capacity);
-    if (!b->data)
-        mml_sys_oom_abort();
-    return b;
+    if (arena_base)
+        return 1;
+    if (arena_unavailable)
+        return 0;
+#ifdef MAP_NORESERVE
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+    void *mem = mmap(NULL, MML_ARENA_RESERVE, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        arena_unavailable = 1;
+        return 0;
+    }
+    arena_base = (char *)mem;
+    arena_top = arena_base;
+    arena_high = arena_base;
+    arena_end = arena_base + MML_ARENA_RESERVE;
+    mml_thread_attach();
+    return 1;
 }
 
-Buffer mkBufferWithFd(int fd)
+// Unmaps the calling thread's reservation at thread exit.
+static void mml_arena_release(void)
 {
-    Buffer b = (Buffer)malloc(sizeof(BufferImpl));
-    if (!b)
-        mml_sys_oom_abort();
-    b->capacity = 4096;
-    b->length = 0;
-    b->fd = fd;
-    b->data = (char *)malloc(b->capacity);
-    if (!b->data)
-        mml_sys_oom_abort();
-    return b;
+    if (!arena_base)
+        return;
+    munmap(arena_base, MML_ARENA_RESERVE);
+    arena_base = arena_top = arena_end = arena_high = NULL;
+    arena_depth = 0;
 }
 
-Buffer mkBufferWithSize(int64_t size)
+static inline int mml_arena_owns(const void *p)
 {
-    Buffer b = (Buffer)malloc(sizeof(BufferImpl));
-    if (!b)
-        mml_sys_oom_abort();
-    b->capacity = size > 0 ? (size_t)size : 4096;
-    b->length = 0;
-    b->fd = STDOUT_FILENO;
-    b->data = (char *)malloc(b->capacity);
-    if (!b->data)
-        mml_sys_oom_abort();
-    return b;
+    return (const char *)p >= arena_base && (const char *)p < arena_end;
 }
 
-static Buffer stdout_buffer = NULL;
-
-static Buffer get_stdout_buffer(void)
+void mml_arena_push(void)
 {
-    if (!stdout_buffer)
-        stdout_buffer = mkBuffer();
-    return stdout_buffer;
+    if (!mml_arena_init())
+        return;
+    if (arena_depth < MML_ARENA_MAX_DEPTH)
+        arena_marks[arena_depth] = arena_top;
+    arena_depth++;
 }
 
-void flush(Buffer b)
+void mml_arena_pop(void)
 {
-    if (b && b->data && b->length > 0)
+    if (arena_depth == 0)
+        return;
+    arena_depth--;
+    // Regions nested deeper than MML_ARENA_MAX_DEPTH release with their outer region.
+    if (arena_depth >= MML_ARENA_MAX_DEPTH)
+        return;
+    arena_top = arena_marks[arena_depth];
+
+    if (arena_depth == 0 && arena_high > arena_base + MML_ARENA_RETAIN)
     {
-        write(b->fd, b->data, b->length);
-        b->length = 0;
+        // Hand pages beyond the retained prefix back to the OS after a large region.
+        char *release = arena_base + MML_ARENA_RETAIN;
+#ifdef MADV_FREE
+        madvise(release, (size_t)(arena_high - release), MADV_FREE);
+#else
+        madvise(release, (size_t)(arena_high - release), MADV_DONTNEED);
+#endif
+        arena_high = release;
     }
 }
 
-void mml_sys_flush()
+static inline void *mml_arena_alloc(size_t size)
 {
-    Buffer out = get_stdout_buffer();
-    if (out)
-        flush(out);
+    size_t rounded = (size + (MML_ALLOC_ALIGN - 1)) & ~(size_t)(MML_ALLOC_ALIGN - 1);
+    if (rounded < size || rounded > (size_t)(arena_end - arena_top))
+        return NULL;
+    char *p = arena_top;
+    arena_top += rounded;
+    if (arena_top > arena_high)
+        arena_high = arena_top;
+    return p;
 }
 
-
-
-FORCE_INLINE void buffer_write(Buffer b, String s)
+// --- Runtime Statistics ---
+// A runtime built with -DMML_STATS (mmlc --runtime-stats) counts heap allocations,
+// clones and frees per value kind, flushes and write syscalls, and prints a summary at
+// exit. Without it every MML_STAT_* hook below compiles to nothing.
+// Each thread counts into its own block, so the hot paths take no locks; the blocks are
+// summed for the report. Blocks are static, so attaching never allocates (a signal
+// drain may be the first thing a thread counts); threads beyond MML_STATS_BLOCKS share
+// the last one and may lose increments. Live and peak heap bytes are process-wide
+// atomics, taken from the allocator's usable size, and cover value payloads allocated
+// through mml_alloc and the string pool; arena allocations are counted separately.
+// MML_STATS=0 silences the report and MML_STATS=<path> appends it to a file instead of
+// stderr.
+
+#define MML_STAT_KIND_LIST(X)                                                          \
+    X(String)                                                                          \
+    X(IntArray)                                                                        \
+    X(FloatArray)                                                                      \
+    X(Int8Array)                                                                       \
+    X(Int32Array)                                                                      \
+    X(DoubleArray)                                                                     \
+    X(StringArray)                                                                     \
+    X(Buffer)                                                                          \
+    X(Reader)                                                                          \
+    X(MappedFile)                                                                      \
+    X(EventLoop)                                                                       \
+    X(IntMap)                                                                          \
+    X(StringMap)                                                                       \
+    X(StringSet)
+
+#ifdef MML_STATS
+
+#define MML_STAT_KIND_ENUM(Name) MML_STAT_KIND_##Name,
+enum
 {
-    if (!b || !s.data)
-        return;
+    MML_STAT_KIND_LIST(MML_STAT_KIND_ENUM) MML_STAT_KINDS
+};
+
+#define MML_STAT_KIND_NAME(Name) #Name,
+static const char *const mml_stat_kind_names[MML_STAT_KINDS] = {
+    MML_STAT_KIND_LIST(MML_STAT_KIND_NAME)};
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define MML_STAT_USABLE(p) malloc_size(p)
+#elif defined(__linux__)
+#include <malloc.h>
+#define MML_STAT_USABLE(p) malloc_usable_size(p)
+#else
+#define MML_STAT_USABLE(p) ((size_t)0) // live/peak heap are not tracked
+#endif
 
-    // Auto-flush if this write would overflow
-    if (b->length + s.length >= b->capacity)
-        flush(b);
+#define MML_STATS_BLOCKS 264 // the main thread, MML_POOL_MAX_WORKERS workers and some spare
 
-    memcpy(b->data + b->length, s.data, s.length);
-    b->length += s.length;
+typedef struct
+{
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+    uint64_t arena_allocs;
+    uint64_t arena_bytes;
+    uint64_t reallocs;
+    uint64_t frees;
+    uint64_t flushes;
+    uint64_t write_calls;
+    uint64_t bytes_written;
+    uint64_t str_pool_hits;
+    uint64_t str_pool_misses;
+    uint64_t str_pool_recycled;
+    uint64_t str_pool_dropped;
+    uint64_t clones[MML_STAT_KINDS];
+    uint64_t clone_bytes[MML_STAT_KINDS];
+    uint64_t kind_frees[MML_STAT_KINDS];
+} MmlStats;
+
+static MmlStats mml_stats_blocks[MML_STATS_BLOCKS];
+static atomic_int mml_stats_used;
+static _Thread_local MML_TLS_MODEL MmlStats *mml_stats_self;
+static _Atomic int64_t mml_stats_live;
+static _Atomic int64_t mml_stats_peak;
+
+__attribute__((noinline)) static MmlStats *mml_stats_attach(void)
+{
+    int i = atomic_fetch_add_explicit(&mml_stats_used, 1, memory_order_relaxed);
+    mml_stats_self = &mml_stats_blocks[i < MML_STATS_BLOCKS ? i : MML_STATS_BLOCKS - 1];
+    return mml_stats_self;
 }
 
-FORCE_INLINE void buffer_writeln(Buffer b, String s)
+static inline MmlStats *mml_stats(void)
 {
-    if (!b)
-        return;
-
-    // Auto-flush if this write would overflow (string + newline)
-    if (b->length + s.length + 1 >= b->capacity)
-        flush(b);
-
-    if (s.data)
-    {
-        memcpy(b->data + b->length, s.data, s.length);
-        b->length += s.length;
-    }
-    b->data[b->length++] = '\n';
+    MmlStats *s = mml_stats_self;
+    return s ? s : mml_stats_attach();
 }
 
-FORCE_INLINE static size_t format_int64(char *buffer, size_t size, int64_t value)
+static inline void mml_stats_heap(int64_t delta)
 {
-    if (!buffer || size == 0)
-        return 0;
-
-    char digits[24];
-    size_t d = 0;
-    size_t pos = 0;
-    int64_t abs_value = value;
-
-    if (value < 0)
+    int64_t live =
+        atomic_fetch_add_explicit(&mml_stats_live, delta, memory_order_relaxed) + delta;
+    int64_t peak = atomic_load_explicit(&mml_stats_peak, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(
+                              &mml_stats_peak, &peak, live, memory_order_relaxed,
+                              memory_order_relaxed))
     {
-        if (pos + 1 >= size)
-            return 0;
-        buffer[pos++] = '-';
-        abs_value = -value;
     }
+}
 
-    if (abs_value == 0)
+#define MML_STAT_ADD(field, n) (mml_stats()->field += (uint64_t)(n))
+#define MML_STAT_HEAP(delta) mml_stats_heap((int64_t)(delta))
+#define MML_STAT_CLONE(Name, bytes)                                                    \
+    do                                                                                 \
+    {                                                                                  \
+        MmlStats *mml_s = mml_stats();                                                 \
+        mml_s->clones[MML_STAT_KIND_##Name]++;                                         \
+        mml_s->clone_bytes[MML_STAT_KIND_##Name] += (uint64_t)(bytes);                 \
+    } while (0)
+#define MML_STAT_FREE(Name) (mml_stats()->kind_frees[MML_STAT_KIND_##Name]++)
+
+static void mml_stats_report(void)
+{
+    const char *dest = getenv("MML_STATS");
+    if (dest && strcmp(dest, "0") == 0)
+        return;
+    FILE *out = stderr;
+    if (dest && *dest && strcmp(dest, "1") != 0)
     {
-        if (pos + 1 >= size)
-            return 0;
-        buffer[pos++] = '0';
-        return pos;
+        out = fopen(dest, "a");
+        if (!out)
+            return;
     }
 
-    while (abs_value > 0 && d < sizeof(digits))
+    MmlStats total;
+    memset(&total, 0, sizeof(total));
+    int used = atomic_load_explicit(&mml_stats_used, memory_order_relaxed);
+    if (used > MML_STATS_BLOCKS)
+        used = MML_STATS_BLOCKS;
+    uint64_t *sum = (uint64_t *)&total;
+    for (int t = 0; t < used; t++)
     {
-        int64_t q = abs_value / 10;
-        int64_t r = abs_value - q * 10;
-        digits[d++] = (char)('0' + r);
-        abs_value = q;
+        // Other threads may still be counting; their totals are read as they stand.
+        const uint64_t *block = (const uint64_t *)&mml_stats_blocks[t];
+        for (size_t f = 0; f < sizeof(MmlStats) / sizeof(uint64_t); f++)
+            sum[f] += block[f];
     }
 
-    if (pos + d >= size)
-        return 0;
-
-    while (d > 0)
+    fprintf(out,
+            "mml stats: allocs=%llu alloc_bytes=%llu arena_allocs=%llu arena_bytes=%llu "
+            "reallocs=%llu frees=%llu\n",
+            (unsigned long long)total.allocs, (unsigned long long)total.alloc_bytes,
+            (unsigned long long)total.arena_allocs, (unsigned long long)total.arena_bytes,
+            (unsigned long long)total.reallocs, (unsigned long long)total.frees);
+    fprintf(out, "mml stats: peak_heap=%lld live_heap_at_exit=%lld threads=%d\n",
+            (long long)atomic_load(&mml_stats_peak), (long long)atomic_load(&mml_stats_live),
+            used);
+    fprintf(out, "mml stats: flushes=%llu write_calls=%llu bytes_written=%llu\n",
+            (unsigned long long)total.flushes, (unsigned long long)total.write_calls,
+            (unsigned long long)total.bytes_written);
+    fprintf(out,
+            "mml stats: str_pool_hits=%llu str_pool_misses=%llu str_pool_recycled=%llu "
+            "str_pool_dropped=%llu\n",
+            (unsigned long long)total.str_pool_hits, (unsigned long long)total.str_pool_misses,
+            (unsigned long long)total.str_pool_recycled,
+            (unsigned long long)total.str_pool_dropped);
+    for (int k = 0; k < MML_STAT_KINDS; k++)
     {
-        buffer[pos++] = digits[--d];
+        if (total.clones[k] == 0 && total.kind_frees[k] == 0)
+            continue;
+        fprintf(out, "mml stats: %-11s clones=%llu clone_bytes=%llu frees=%llu\n",
+                mml_stat_kind_names[k], (unsigned long long)total.clones[k],
+                (unsigned long long)total.clone_bytes[k],
+                (unsigned long long)total.kind_frees[k]);
     }
-
-    return pos;
+    if (out != stderr)
+        fclose(out);
+    else
+        fflush(stderr);
 }
 
-FORCE_INLINE void buffer_write_int(Buffer b, int64_t value)
+// Registered before any Buffer exists, so it runs after the exit drain and sees its
+// flushes.
+__attribute__((constructor)) static void mml_stats_init(void)
 {
-    if (!b)
-        return;
+    atexit(mml_stats_report);
+}
 
-    char buf[32];
-    size_t len = format_int64(buf, sizeof(buf), value);
-    if (len == 0)
-        return;
+#else
 
-    if (b->length + len >= b->capacity)
-        flush(b);
+#define MML_STAT_ADD(field, n) ((void)0)
+#define MML_STAT_HEAP(delta) ((void)0)
+#define MML_STAT_CLONE(Name, bytes) ((void)0)
+#define MML_STAT_FREE(Name) ((void)0)
+#define MML_STAT_USABLE(p) ((size_t)0)
+
+#endif
+
+// --- Runtime Heap ---
+// Every heap allocation made on behalf of an MML value goes through these helpers.
 
-    memcpy(b->data + b->length, buf, len);
-    b->length += len;
+static inline void *mml_alloc(size_t size)
+{
+    if (arena_depth > 0)
+    {
+        void *p = mml_arena_alloc(size);
+        if (p)
+        {
+            MML_STAT_ADD(arena_allocs, 1);
+            MML_STAT_ADD(arena_bytes, size);
+            return p;
+        }
+    }
+    void *p = malloc(size);
+    if (!p)
+        mml_sys_oom_abort();
+    MML_STAT_ADD(allocs, 1);
+    MML_STAT_ADD(alloc_bytes, size);
+    MML_STAT_HEAP(MML_STAT_USABLE(p));
+    return p;
 }
 
-FORCE_INLINE void buffer_writeln_int(Buffer b, int64_t value)
+static inline void *mml_realloc(void *p, size_t old_size, size_t new_size)
 {
-    if (!b)
-        return;
+    if (p && mml_arena_owns(p))
+    {
+        void *moved = mml_alloc(new_size);
+        memcpy(moved, p, old_size < new_size ? old_size : new_size);
+        return moved;
+    }
+    MML_STAT_ADD(reallocs, 1);
+#ifdef MML_STATS
+    int64_t before = p ? (int64_t)MML_STAT_USABLE(p) : 0;
+#endif
+    void *grown = realloc(p, new_size);
+    if (!grown)
+        mml_sys_oom_abort();
+    MML_STAT_HEAP((int64_t)MML_STAT_USABLE(grown) - before);
+    return grown;
+}
 
-    char buf[32];
-    size_t len = format_int64(buf, sizeof(buf), value);
-    if (len == 0)
-        return;
+static inline void mml_free(void *p)
+{
+    if (p && !mml_arena_owns(p))
+    {
+        MML_STAT_ADD(frees, 1);
+        MML_STAT_HEAP(-(int64_t)MML_STAT_USABLE(p));
+        free(p);
+    }
+}
 
-    if (b->length + len + 1 >= b->capacity)
-        flush(b);
+// --- Small String Pool ---
+// String payloads of up to MML_STR_POOL_MAX bytes are rounded up to a size class and
+// recycled through per-class free lists instead of round-tripping through malloc.
+// mml_str_release derives the class from the string length, so every payload that can
+// reach a free list must have been allocated with at least its class size.
+// The free lists are per thread, so neither path locks; a block may be released on a
+// different thread than the one that allocated it. A thread's cached blocks go back to
+// malloc when it exits. Hit, miss, recycle and drop counts are part of the MML_STATS
+// report.
+
+#define MML_STR_POOL_CLASSES 4
+#define MML_STR_POOL_MAX 128
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MML_ASAN 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define MML_ASAN 1
+#endif
 
-    memcpy(b->data + b->length, buf, len);
-    b->length += len;
-    b->data[b->length++] = '\n';
-}
+// Under ASan recycled blocks would hide use-after-free, so nothing is cached.
+#ifdef MML_ASAN
+#define MML_STR_POOL_DEPTH 0
+#else
+#define MML_STR_POOL_DEPTH 4096
+#endif
 
-FORCE_INLINE void buffer_write_float(Buffer b, float value)
+typedef struct StrPoolBlock
 {
-    if (!b)
-        return;
-    char buf[32];
-    int len = snprintf(buf, sizeof(buf), "%g", (double)value);
-    if (len <= 0)
-        return;
-    if (b->length + len >= b->capacity)
-        flush(b);
-    memcpy(b->data + b->length, buf, len);
-    b->length += len;
-}
+    struct StrPoolBlock *next;
+} StrPoolBlock;
 
-FORCE_INLINE void buffer_writeln_float(Buffer b, float value)
+static _Thread_local StrPoolBlock *str_pool_free[MML_STR_POOL_CLASSES];
+static _Thread_local size_t str_pool_count[MML_STR_POOL_CLASSES];
+
+static inline int mml_str_class(size_t size)
 {
-    if (!b)
-        return;
-    char buf[32];
-    int len = snprintf(buf, sizeof(buf), "%g", (double)value);
-    if (len <= 0)
-        return;
-    if (b->length + len + 1 >= b->capacity)
-        flush(b);
-    memcpy(b->data + b->length, buf, len);
-    b->length += len;
-    b->data[b->length++] = '\n';
+    if (size <= 16)
+        return 0;
+    if (size <= 32)
+        return 1;
+    if (size <= 64)
+        return 2;
+    if (size <= MML_STR_POOL_MAX)
+        return 3;
+    return -1;
 }
 
-// --- Read a line from stdin ---
-String readline()
+static inline char *mml_str_alloc(size_t size)
 {
-    mml_sys_flush();
-    size_t size = 1024;
-    char *buffer = (char *)malloc(size);
-    if (!buffer)
-        mml_sys_oom_abort();
+    int cls = mml_str_class(size);
+    if (cls < 0)
+        return (char *)mml_alloc(size);
 
-    if (fgets(buffer, size, stdin))
+    size_t class_size = (size_t)16 << cls;
+    if (arena_depth > 0)
     {
-        buffer[strcspn(buffer, "\n")] = 0;
-        return (String){strlen(buffer), buffer};
+        void *p = mml_arena_alloc(class_size);
+        if (p)
+        {
+            MML_STAT_ADD(arena_allocs, 1);
+            MML_STAT_ADD(arena_bytes, size);
+            return (char *)p;
+        }
     }
 
-    // Check if we hit EOF
-    if (feof(stdin))
+    // Pooled blocks count as live from hand-out to release, whether or not they came
+    // from malloc.
+    MML_STAT_ADD(allocs, 1);
+    MML_STAT_ADD(alloc_bytes, size);
+    MML_STAT_HEAP(class_size);
+
+    StrPoolBlock *block = str_pool_free[cls];
+    if (block)
     {
-        clearerr(stdin); // Clear the EOF flag
+        str_pool_free[cls] = block->next;
+        str_pool_count[cls]--;
+        MML_STAT_ADD(str_pool_hits, 1);
+        return (char *)block;
     }
 
-    free(buffer);
-    return (String){0, NULL};
+    MML_STAT_ADD(str_pool_misses, 1);
+    char *p = (char *)malloc(class_size);
+    if (!p)
+        mml_sys_oom_abort();
+    return p;
 }
 
-// --- Print a string (no newline) ---
-void print(String str)
+static inline void mml_str_release(char *p, size_t size)
 {
-    Buffer out = get_stdout_buffer();
-    if (out)
+    if (!p || mml_arena_owns(p))
+        return;
+
+    int cls = mml_str_class(size);
+    MML_STAT_ADD(frees, 1);
+    MML_STAT_HEAP(-(int64_t)(cls >= 0 ? (size_t)16 << cls : MML_STAT_USABLE(p)));
+    if (cls >= 0 && str_pool_count[cls] < MML_STR_POOL_DEPTH)
     {
-        buffer_write(out, str);
+        mml_thread_attach();
+        StrPoolBlock *block = (StrPoolBlock *)p;
+        block->next = str_pool_free[cls];
+        str_pool_free[cls] = block;
+        str_pool_count[cls]++;
+        MML_STAT_ADD(str_pool_recycled, 1);
+        return;
     }
-    else if (str.data)
-        write(STDOUT_FILENO, str.data, str.length);
+    if (cls >= 0)
+        MML_STAT_ADD(str_pool_dropped, 1);
+    free(p);
 }
 
-// --- StringBuilder ---
-typedef struct
+// Returns the calling thread's cached blocks to malloc.
+static void mml_str_pool_drain(void)
 {
-    size_t capacity;
-    size_t length;
-    char *buffer;
-} StringBuilder;
+    for (int cls = 0; cls < MML_STR_POOL_CLASSES; cls++)
+    {
+        StrPoolBlock *block = str_pool_free[cls];
+        while (block)
+        {
+            StrPoolBlock *next = block->next;
+            free(block);
+            block = next;
+        }
+        str_pool_free[cls] = NULL;
+        str_pool_count[cls] = 0;
+    }
+}
 
-StringBuilder *string_builder_new(size_t initial_capacity)
-{
-    StringBuilder *sb = (StringBuilder *)malloc(sizeof(StringBuilder));
-    if (!sb)
-        mml_sys_oom_abort();
+// --- SIMD Kernels and CPU Dispatch ---
+// Each vectorized routine has a baseline version built for whatever the runtime is
+// compiled for (scalar, SSE2, or AVX2 with -march; NEON on AArch64). On x86-64 the
+// runtime also carries AVX2 and AVX-512 versions compiled with target attributes, and
+// a constructor picks the widest one the running CPU supports, so one binary runs
+// well on a mixed fleet. MML_CPU=baseline|avx2|avx512 caps the choice (for testing).
+// The digit formatters are plain integer code and have no CPU-specific versions.
+
+#if defined(__AVX2__)
+#define MML_SIMD_AVX2 1
+#elif defined(__SSE2__)
+#define MML_SIMD_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MML_SIMD_NEON 1
+#endif
 
-    sb->buffer = (char *)malloc(initial_capacity);
-    if (!sb->buffer)
-        mml_sys_oom_abort();
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(__AVX512F__)
+#define MML_CPU_DISPATCH 1
+#endif
 
-    sb->capacity = initial_capacity;
-    sb->length = 0;
-    return sb;
+static int mml_bytes_eq_base(const char *a, const char *b, size_t n)
+{
+    return memcmp(a, b, n) == 0;
 }
 
-void string_builder_append(StringBuilder *sb, String str)
+static void mml_fill_i64_base(int64_t *p, size_t n, int64_t v)
 {
-    if (!sb || !str.data)
-        return;
+    size_t i = 0;
+#if defined(MML_SIMD_AVX2)
+    __m256i vv = _mm256_set1_epi64x(v);
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)(p + i), vv);
+#elif defined(MML_SIMD_SSE2)
+    __m128i vv = _mm_set1_epi64x(v);
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_si128((__m128i *)(p + i), vv);
+#elif defined(MML_SIMD_NEON)
+    int64x2_t vv = vdupq_n_s64(v);
+    for (; i + 2 <= n; i += 2)
+        vst1q_s64(p + i, vv);
+#endif
+    for (; i < n; i++)
+        p[i] = v;
+}
 
-    if (sb->length + str.length >= sb->capacity)
+static int64_t mml_sum_i64_base(const int64_t *p, size_t n)
+{
+    size_t i = 0;
+    uint64_t sum = 0;
+#if defined(MML_SIMD_AVX2)
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8)
     {
-        sb->capacity *= 2;
-        char *new_buffer = (char *)realloc(sb->buffer, sb->capacity);
-        if (!new_buffer)
-            mml_sys_oom_abort();
-        sb->buffer = new_buffer;
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256((const __m256i *)(p + i)));
+        a1 = _mm256_add_epi64(a1, _mm256_loadu_si256((const __m256i *)(p + i + 4)));
     }
-    memcpy(sb->buffer + sb->length, str.data, str.length);
-    sb->length += str.length;
-    sb->buffer[sb->length] = '\0';
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(a0, a1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(MML_SIMD_SSE2)
+    __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4)
+    {
+        a0 = _mm_add_epi64(a0, _mm_loadu_si128((const __m128i *)(p + i)));
+        a1 = _mm_add_epi64(a1, _mm_loadu_si128((const __m128i *)(p + i + 2)));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(a0, a1));
+    sum = lanes[0] + lanes[1];
+#elif defined(MML_SIMD_NEON)
+    int64x2_t a0 = vdupq_n_s64(0), a1 = vdupq_n_s64(0);
+    for (; i + 4 <= n; i += 4)
+    {
+        a0 = vaddq_s64(a0, vld1q_s64(p + i));
+        a1 = vaddq_s64(a1, vld1q_s64(p + i + 2));
+    }
+    sum = (uint64_t)vaddvq_s64(vaddq_s64(a0, a1));
+#endif
+    for (; i < n; i++)
+        sum += (uint64_t)p[i];
+    return (int64_t)sum;
 }
 
-String string_builder_finalize(StringBuilder *sb)
+static int64_t mml_count_eq_i64_base(const int64_t *p, size_t n, int64_t v)
 {
-    if (!sb)
-        return (String){0, NULL};
-
-    char *data = (char *)malloc(sb->length + 1);
-    if (!data)
-        mml_sys_oom_abort();
-
-    String result = {sb->length, data};
-    memcpy(result.data, sb->buffer, sb->length);
-    result.data[result.length] = '\0';
-    free(sb->buffer);
-    free(sb);
-    return result;
+    size_t i = 0;
+    int64_t count = 0;
+#if defined(MML_SIMD_AVX2)
+    // Equal lanes compare to -1, so subtracting the mask counts them.
+    __m256i vv = _mm256_set1_epi64x(v), acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_sub_epi64(
+            acc, _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(p + i)), vv));
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(MML_SIMD_SSE2)
+    // SSE2 has no 64-bit compare: both 32-bit halves must match.
+    __m128i vv = _mm_set1_epi64x(v), acc = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(p + i)), vv);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        acc = _mm_sub_epi64(acc, eq);
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    count = lanes[0] + lanes[1];
+#elif defined(MML_SIMD_NEON)
+    int64x2_t vv = vdupq_n_s64(v), acc = vdupq_n_s64(0);
+    for (; i + 2 <= n; i += 2)
+        acc = vsubq_s64(acc, vreinterpretq_s64_u64(vceqq_s64(vld1q_s64(p + i), vv)));
+    count = vaddvq_s64(acc);
+#endif
+    for (; i < n; i++)
+        count += p[i] == v;
+    return count;
 }
 
-// --- Print a string with newline ---
-void println(String str)
+static float mml_dot_f32_base(const float *a, const float *b, size_t n)
 {
-    Buffer out = get_stdout_buffer();
-    if (out)
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(MML_SIMD_AVX2)
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16)
     {
-        buffer_writeln(out, str);
+        a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        a1 = _mm256_add_ps(
+            a1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
     }
-    else if (str.data)
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(a0, a1));
+    for (int l = 0; l < 8; l++)
+        sum += lanes[l];
+#elif defined(MML_SIMD_SSE2)
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8)
     {
-        struct iovec iov[2];
-        iov[0].iov_base = str.data;
-        iov[0].iov_len = str.length;
-        iov[1].iov_base = "\n";
-        iov[1].iov_len = 1;
-        writev(STDOUT_FILENO, iov, 2);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
     }
-    else
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(a0, a1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(MML_SIMD_NEON)
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8)
     {
-        write(STDOUT_FILENO, "\n", 1);
+        a0 = vfmaq_f32(a0, vld1q_f32(a + i), vld1q_f32(b + i));
+        a1 = vfmaq_f32(a1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
     }
+    sum = vaddvq_f32(vaddq_f32(a0, a1));
+#endif
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
 }
 
-// --- Substring ---
-String substring(String s, size_t start, size_t len)
+static void mml_axpy_f32_base(float alpha, const float *x, float *y, size_t n)
 {
-    if (start >= s.length || !s.data)
-        return (String){0, NULL};
-    if (start + len > s.length)
-        len = s.length - start;
-
-    char *new_data = (char *)malloc(len + 1);
-    if (!new_data)
-        mml_sys_oom_abort();
-
-    memcpy(new_data, s.data + start, len);
-    new_data[len] = '\0';
-    return (String){len, new_data};
+    size_t i = 0;
+#if defined(MML_SIMD_AVX2)
+    __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                                              _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+#elif defined(MML_SIMD_SSE2)
+    __m128 va = _mm_set1_ps(alpha);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+#elif defined(MML_SIMD_NEON)
+    float32x4_t va = vdupq_n_f32(alpha);
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), va, vld1q_f32(x + i)));
+#endif
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
 }
 
-// --- Free String Memory ---
-void free_string(String str)
+typedef struct
+{
+    int (*bytes_eq)(const char *, const char *, size_t);
+    void (*fill_i64)(int64_t *, size_t, int64_t);
+    int64_t (*sum_i64)(const int64_t *, size_t);
+    int64_t (*count_eq_i64)(const int64_t *, size_t, int64_t);
+    float (*dot_f32)(const float *, const float *, size_t);
+    void (*axpy_f32)(float, const float *, float *, size_t);
+} MmlKernels;
+
+static MmlKernels mml_kernels = {
+    mml_bytes_eq_base, mml_fill_i64_base, mml_sum_i64_base,
+    mml_count_eq_i64_base, mml_dot_f32_base, mml_axpy_f32_base,
+};
+
+#if defined(MML_CPU_DISPATCH)
+#if !defined(__AVX2__)
+#define MML_AVX2 __attribute__((target("avx2")))
+
+// Inputs shorter than one vector go to memcmp; otherwise the last chunk overlaps the
+// previous one instead of falling back to a byte loop.
+MML_AVX2 static int mml_bytes_eq_avx2(const char *a, const char *b, size_t n)
 {
-    if (str.data)
+    if (n < 32)
+        return memcmp(a, b, n) == 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
     {
-        free(str.data);
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                     _mm256_loadu_si256((const __m256i *)(b + i)));
+        if (!_mm256_testz_si256(x, x))
+            return 0;
     }
+    if (i == n)
+        return 1;
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + n - 32)),
+                                 _mm256_loadu_si256((const __m256i *)(b + n - 32)));
+    return _mm256_testz_si256(x, x);
+}
+
+MML_AVX2 static void mml_fill_i64_avx2(int64_t *p, size_t n, int64_t v)
+{
+    size_t i = 0;
+    __m256i vv = _mm256_set1_epi64x(v);
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)(p + i), vv);
+    for (; i < n; i++)
+        p[i] = v;
+}
+
+MML_AVX2 static int64_t mml_sum_i64_avx2(const int64_t *p, size_t n)
+{
+    size_t i = 0;
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8)
+    {
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256((const __m256i *)(p + i)));
+        a1 = _mm256_add_epi64(a1, _mm256_loadu_si256((const __m256i *)(p + i + 4)));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(a0, a1));
+    uint64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++)
+        sum += (uint64_t)p[i];
+    return (int64_t)sum;
+}
+
+MML_AVX2 static int64_t mml_count_eq_i64_avx2(const int64_t *p, size_t n, int64_t v)
+{
+    size_t i = 0;
+    __m256i vv = _mm256_set1_epi64x(v), acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_sub_epi64(
+            acc, _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(p + i)), vv));
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    int64_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++)
+        count += p[i] == v;
+    return count;
+}
+
+MML_AVX2 static float mml_dot_f32_avx2(const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16)
+    {
+        a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        a1 = _mm256_add_ps(
+            a1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(a0, a1));
+    float sum = 0.0f;
+    for (int l = 0; l < 8; l++)
+        sum += lanes[l];
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+MML_AVX2 static void mml_axpy_f32_avx2(float alpha, const float *x, float *y, size_t n)
+{
+    size_t i = 0;
+    __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                                              _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+#endif
+
+#define MML_AVX512 __attribute__((target("avx512f,avx512bw")))
+
+MML_AVX512 static int mml_bytes_eq_avx512(const char *a, const char *b, size_t n)
+{
+    if (n < 64)
+        return memcmp(a, b, n) == 0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        if (_mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)))
+            return 0;
+    if (i == n)
+        return 1;
+    return _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a + n - 64),
+                                   _mm512_loadu_si512(b + n - 64)) == 0;
+}
+
+MML_AVX512 static void mml_fill_i64_avx512(int64_t *p, size_t n, int64_t v)
+{
+    size_t i = 0;
+    __m512i vv = _mm512_set1_epi64(v);
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_si512(p + i, vv);
+    for (; i < n; i++)
+        p[i] = v;
+}
+
+MML_AVX512 static int64_t mml_sum_i64_avx512(const int64_t *p, size_t n)
+{
+    size_t i = 0;
+    __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+    for (; i + 16 <= n; i += 16)
+    {
+        a0 = _mm512_add_epi64(a0, _mm512_loadu_si512(p + i));
+        a1 = _mm512_add_epi64(a1, _mm512_loadu_si512(p + i + 8));
+    }
+    uint64_t sum = (uint64_t)_mm512_reduce_add_epi64(_mm512_add_epi64(a0, a1));
+    for (; i < n; i++)
+        sum += (uint64_t)p[i];
+    return (int64_t)sum;
+}
+
+MML_AVX512 static int64_t mml_count_eq_i64_avx512(const int64_t *p, size_t n, int64_t v)
+{
+    size_t i = 0;
+    int64_t count = 0;
+    __m512i vv = _mm512_set1_epi64(v);
+    for (; i + 8 <= n; i += 8)
+        count += __builtin_popcount(
+            (unsigned)_mm512_cmpeq_epi64_mask(_mm512_loadu_si512(p + i), vv));
+    for (; i < n; i++)
+        count += p[i] == v;
+    return count;
+}
+
+MML_AVX512 static float mml_dot_f32_avx512(const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+    for (; i + 32 <= n; i += 32)
+    {
+        a0 = _mm512_add_ps(a0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        a1 = _mm512_add_ps(
+            a1, _mm512_mul_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16)));
+    }
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(a0, a1));
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+MML_AVX512 static void mml_axpy_f32_avx512(float alpha, const float *x, float *y, size_t n)
+{
+    size_t i = 0;
+    __m512 va = _mm512_set1_ps(alpha);
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i),
+                                              _mm512_mul_ps(va, _mm512_loadu_ps(x + i))));
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+__attribute__((constructor)) static void mml_select_kernels(void)
+{
+    const char *cap = getenv("MML_CPU");
+    int level = 2;
+    if (cap && strcmp(cap, "baseline") == 0)
+        level = 0;
+    else if (cap && strcmp(cap, "avx2") == 0)
+        level = 1;
+
+    __builtin_cpu_init();
+    if (level >= 2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        mml_kernels = (MmlKernels){
+            mml_bytes_eq_avx512, mml_fill_i64_avx512, mml_sum_i64_avx512,
+            mml_count_eq_i64_avx512, mml_dot_f32_avx512, mml_axpy_f32_avx512,
+        };
+    }
+#if !defined(__AVX2__)
+    else if (level >= 1 && __builtin_cpu_supports("avx2"))
+    {
+        mml_kernels = (MmlKernels){
+            mml_bytes_eq_avx2, mml_fill_i64_avx2, mml_sum_i64_avx2,
+            mml_count_eq_i64_avx2, mml_dot_f32_avx2, mml_axpy_f32_avx2,
+        };
+    }
+#endif
+}
+#endif
+
+// --- String Struct ---
+typedef struct String
+{
+    size_t length;
+    char *data;
+} String;
+
+// --- Small-String Optimisation ---
+// Strings of up to MML_SSO_MAX bytes live inside the 16-byte struct itself: the bytes
+// occupy offsets 0..14 and the last byte holds MML_SSO_TAG | length. That byte is the
+// top byte of `data` on little-endian 64-bit targets, which is zero for any user-space
+// pointer, so heap strings and compiler-emitted literals keep the plain {length, data}
+// form. Runtime code must read strings through mml_str_len / mml_str_ptr.
+// Build with -DMML_NO_SSO on targets that tag the top pointer byte.
+#if !defined(MML_NO_SSO) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && UINTPTR_MAX == UINT64_MAX
+#define MML_SSO_MAX 15
+#else
+#define MML_SSO_MAX 0
+#endif
+#define MML_SSO_TAG 0x80
+
+static inline int mml_str_is_inline(const String *s)
+{
+#if MML_SSO_MAX
+    return (((const unsigned char *)s)[sizeof(String) - 1] & MML_SSO_TAG) != 0;
+#else
+    (void)s;
+    return 0;
+#endif
+}
+
+static inline size_t mml_str_len(const String *s)
+{
+    if (mml_str_is_inline(s))
+        return ((const unsigned char *)s)[sizeof(String) - 1] & ~MML_SSO_TAG;
+    return s->length;
+}
+
+static inline const char *mml_str_ptr(const String *s)
+{
+    return mml_str_is_inline(s) ? (const char *)s : s->data;
+}
+
+// Owned copy of src[0..len): inline when it fits, otherwise a pooled heap payload.
+// Unused inline bytes are zeroed, so two inline strings are equal iff their structs are.
+static inline String mml_str_from(const char *src, size_t len)
+{
+    if (len == 0)
+        return (String){0, NULL};
+#if MML_SSO_MAX
+    if (len <= MML_SSO_MAX)
+    {
+        String s;
+        memset(&s, 0, sizeof(s));
+        memcpy(&s, src, len);
+        ((unsigned char *)&s)[sizeof(String) - 1] = (unsigned char)(MML_SSO_TAG | len);
+        return s;
+    }
+#endif
+    char *data = mml_str_alloc(len + 1);
+    memcpy(data, src, len);
+    data[len] = '\0';
+    return (String){len, data};
+}
+
+// Take ownership of a NUL-terminated mml_alloc buffer, moving short contents inline.
+static inline String mml_str_adopt(char *buf, size_t len)
+{
+    if (len <= MML_SSO_MAX)
+    {
+        String s = mml_str_from(buf, len);
+        mml_free(buf);
+        return s;
+    }
+    return (String){len, buf};
+}
+
+// --- Array Structs ---
+// Every array is {length, data}; the compiler checks that each *Array type keeps this
+// shape. Scalar-element families are declared here and expanded by MML_DEFINE_ARRAY;
+// StringArray owns its elements and is written out by hand.
+#define MML_ARRAY_STRUCT(Name, Elem) \
+    typedef struct Name              \
+    {                                \
+        int64_t length;              \
+        Elem *data;                  \
+    } Name;
+
+MML_ARRAY_STRUCT(IntArray, int64_t)
+MML_ARRAY_STRUCT(FloatArray, float)
+MML_ARRAY_STRUCT(Int8Array, int8_t)
+MML_ARRAY_STRUCT(Int32Array, int32_t)
+MML_ARRAY_STRUCT(DoubleArray, double)
+
+typedef struct StringArray
+{
+    int64_t length;
+    String *data;
+} StringArray;
+
+// --- Output Buffer ---
+typedef struct BufferImpl
+{
+    size_t capacity;
+    size_t length;
+    char *data;
+    int fd;
+    struct BufferImpl *prev; // live-buffer list, see below
+    struct BufferImpl *next;
+    struct EventLoopImpl *ev_loop; // loop finishing an ev_flush of this buffer, if any
+} BufferImpl;
+
+typedef BufferImpl *Buffer;
+
+#define MML_BUFFER_CAPACITY (64 * 1024)
+
+void flush(Buffer b);
+
+// Every live Buffer is linked, in creation order, into one list that is drained at exit,
+// so output still buffered when the program calls exit (normally, from an out-of-bounds
+// trap, or from a hole) is written rather than lost. The list lock is taken only on
+// Buffer creation and free, so writes stay lock-free. Terminating signals are left
+// alone: a handler could neither take the lock nor flush a Buffer that the interrupted
+// thread is writing into, so output buffered at that point is lost.
+static pthread_mutex_t mml_buffers_lock = PTHREAD_MUTEX_INITIALIZER;
+static Buffer mml_buffers_head;
+static Buffer mml_buffers_tail;
+static pthread_once_t mml_buffers_once = PTHREAD_ONCE_INIT;
+
+static void mml_buffers_drain(void)
+{
+    pthread_mutex_lock(&mml_buffers_lock);
+    for (Buffer b = mml_buffers_head; b; b = b->next)
+        flush(b);
+    pthread_mutex_unlock(&mml_buffers_lock);
+}
+
+static void mml_buffers_init(void)
+{
+    atexit(mml_buffers_drain);
+}
+
+static Buffer mml_buffer_new(size_t capacity, int fd)
+{
+    Buffer b = (Buffer)malloc(sizeof(BufferImpl));
+    if (!b)
+        mml_sys_oom_abort();
+    b->capacity = capacity;
+    b->length = 0;
+    b->fd = fd;
+    b->ev_loop = NULL;
+    b->data = (char *)malloc(b->capacity);
+    if (!b->data)
+        mml_sys_oom_abort();
+
+    pthread_once(&mml_buffers_once, mml_buffers_init);
+    pthread_mutex_lock(&mml_buffers_lock);
+    b->prev = mml_buffers_tail;
+    b->next = NULL;
+    if (mml_buffers_tail)
+        mml_buffers_tail->next = b;
+    else
+        mml_buffers_head = b;
+    mml_buffers_tail = b;
+    pthread_mutex_unlock(&mml_buffers_lock);
+    return b;
+}
+
+static void mml_ev_detach_flush(Buffer b);
+
+// Flush, unlink and free.
+static void mml_buffer_release(Buffer b)
+{
+    if (b->ev_loop)
+        mml_ev_detach_flush(b);
+    flush(b);
+    pthread_mutex_lock(&mml_buffers_lock);
+    if (b->prev)
+        b->prev->next = b->next;
+    else
+        mml_buffers_head = b->next;
+    if (b->next)
+        b->next->prev = b->prev;
+    else
+        mml_buffers_tail = b->prev;
+    pthread_mutex_unlock(&mml_buffers_lock);
+    free(b->data);
+    free(b);
+}
+
+Buffer mkBuffer()
+{
+    return mml_buffer_new(MML_BUFFER_CAPACITY, STDOUT_FILENO);
+}
+
+Buffer mkBufferWithFd(int fd)
+{
+    return mml_buffer_new(MML_BUFFER_CAPACITY, fd);
+}
+
+Buffer mkBufferWithSize(int64_t size)
+{
+    return mml_buffer_new(size > 0 ? (size_t)size : MML_BUFFER_CAPACITY, STDOUT_FILENO);
+}
+
+// Every thread prints into its own stdout buffer, so print/println never lock. Output
+// from different threads interleaves at flush boundaries, not line boundaries: a flush
+// writes whatever is pending, which may end mid-line after a print, and writes of half
+// a buffer or more go straight out with it. The task pool keeps fork-join order:
+// pending output is flushed before tasks are queued and again when each task finishes.
+// A thread's buffer is released when the thread exits; the main thread's is drained at
+// exit with the other live buffers.
+static _Thread_local MML_TLS_MODEL Buffer mml_thread_stdout;
+
+__attribute__((noinline)) static Buffer mml_stdout_create(void)
+{
+    mml_thread_attach();
+    Buffer b = mkBuffer();
+    mml_thread_stdout = b;
+    return b;
+}
+
+// Releasing state may attach the thread again (a recycled string, say); pthread then
+// runs the destructor another round.
+static void mml_thread_exit(void *arg)
+{
+    (void)arg;
+    mml_thread_attached = 0;
+    Buffer out = mml_thread_stdout;
+    mml_thread_stdout = NULL;
+    if (out)
+        mml_buffer_release(out);
+    mml_str_pool_drain();
+    mml_arena_release();
+}
+
+static inline Buffer get_stdout_buffer(void)
+{
+    Buffer b = mml_thread_stdout;
+    return b ? b : mml_stdout_create();
+}
+
+// Write all of iov[0..cnt), resuming after partial writes and EINTR and waiting out
+// EAGAIN on non-blocking fds. Any other error drops the rest, matching the old
+// fire-and-forget write.
+static void mml_writev_all(int fd, struct iovec *iov, int cnt)
+{
+    while (cnt > 0)
+    {
+        ssize_t n = writev(fd, iov, cnt);
+        MML_STAT_ADD(write_calls, 1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Non-blocking fd: wait until it drains instead of dropping output.
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            return;
+        }
+        MML_STAT_ADD(bytes_written, n);
+        size_t done = (size_t)n;
+        while (cnt > 0 && done >= iov->iov_len)
+        {
+            done -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+}
+
+void flush(Buffer b)
+{
+    if (b && b->data && b->length > 0)
+    {
+        MML_STAT_ADD(flushes, 1);
+        struct iovec iov = {b->data, b->length};
+        mml_writev_all(b->fd, &iov, 1);
+        b->length = 0;
+    }
+}
+
+// Flushes the calling thread's stdout buffer. Other threads' output goes out when their
+// tasks finish, when they exit, or at process exit.
+void mml_sys_flush()
+{
+    Buffer out = mml_thread_stdout;
+    if (out)
+        flush(out);
+}
+
+
+
+// Payloads of at least half the capacity skip the staging copy: the pending bytes,
+// the payload and the optional newline go out in one writev. Anything smaller is
+// guaranteed to fit once the buffer has been flushed.
+__attribute__((noinline)) static void buffer_write_direct(Buffer b, const char *p, size_t len,
+                                                          int newline)
+{
+    struct iovec iov[3];
+    int cnt = 0;
+    if (b->length)
+        iov[cnt++] = (struct iovec){b->data, b->length};
+    if (len)
+        iov[cnt++] = (struct iovec){(void *)p, len};
+    if (newline)
+        iov[cnt++] = (struct iovec){"\n", 1};
+    mml_writev_all(b->fd, iov, cnt);
+    b->length = 0;
+}
+
+FORCE_INLINE static void buffer_put(Buffer b, const char *p, size_t len, int newline)
+{
+    if (len >= b->capacity / 2)
+    {
+        buffer_write_direct(b, p, len, newline);
+        return;
+    }
+
+    // Auto-flush if this write would overflow
+    if (b->length + len + (size_t)newline >= b->capacity)
+        flush(b);
+
+    if (len)
+    {
+        memcpy(b->data + b->length, p, len);
+        b->length += len;
+    }
+    if (newline)
+        b->data[b->length++] = '\n';
+}
+
+FORCE_INLINE void buffer_write(Buffer b, String s)
+{
+    size_t len = mml_str_len(&s);
+    if (!b || len == 0)
+        return;
+    buffer_put(b, mml_str_ptr(&s), len, 0);
+}
+
+FORCE_INLINE void buffer_writeln(Buffer b, String s)
+{
+    if (!b)
+        return;
+    buffer_put(b, mml_str_ptr(&s), mml_str_len(&s), 1);
+}
+
+// Two ASCII digits per entry, so formatting takes one division per pair of digits.
+static const char mml_digit_pairs[201] = "00010203040506070809"
+                                         "10111213141516171819"
+                                         "20212223242526272829"
+                                         "30313233343536373839"
+                                         "40414243444546474849"
+                                         "50515253545556575859"
+                                         "60616263646566676869"
+                                         "70717273747576777879"
+                                         "80818283848586878889"
+                                         "90919293949596979899";
+
+#define MML_INT_CHARS 20
+
+FORCE_INLINE static size_t mml_u64_digits(uint64_t v)
+{
+    size_t n = 1;
+    for (;;)
+    {
+        if (v < 10)
+            return n;
+        if (v < 100)
+            return n + 1;
+        if (v < 1000)
+            return n + 2;
+        if (v < 10000)
+            return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+// Writes value into buffer (no terminator) and returns its length, or 0 when size is
+// too small. At most MML_INT_CHARS bytes are needed.
+FORCE_INLINE static size_t format_int64(char *buffer, size_t size, int64_t value)
+{
+    if (!buffer)
+        return 0;
+
+    // Negate in unsigned arithmetic so INT64_MIN is well defined.
+    uint64_t u = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    size_t sign = value < 0;
+    size_t len = sign + mml_u64_digits(u);
+    if (len > size)
+        return 0;
+
+    char *p = buffer + len;
+    while (u >= 100)
+    {
+        const char *pair = mml_digit_pairs + (u % 100) * 2;
+        u /= 100;
+        p -= 2;
+        p[0] = pair[0];
+        p[1] = pair[1];
+    }
+    if (u >= 10)
+    {
+        p -= 2;
+        p[0] = mml_digit_pairs[u * 2];
+        p[1] = mml_digit_pairs[u * 2 + 1];
+    }
+    else
+        *--p = (char)('0' + u);
+
+    if (sign)
+        buffer[0] = '-';
+    return len;
+}
+
+// --- Float Formatting ---
+// Round-trip digits via Grisu2 (Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers"): the value and its rounding boundaries are
+// scaled by a cached power of ten into 64-bit fixed point and digits are cut until the
+// result is inside the boundaries. The interval is narrowed by one ulp on each side, so
+// the output always parses back to the same value; for about 0.1% of doubles it is one
+// digit longer than the shortest (1288.3257698541329 where 1288.325769854133 would do). Float and Double differ only in how the boundaries are computed.
+// Output follows %g: fixed notation for decimal exponents in [-4, 16), else d.ddde+XX.
+
+#define MML_FLOAT_CHARS 32
+
+typedef struct
+{
+    uint64_t f;
+    int e;
+} MmlDiyFp;
+
+// 10^k for k = -348, -340, ..., 340, normalized to a 64-bit significand.
+static const MmlDiyFp mml_cached_pow10[87] = {
+    {0xFA8FD5A0081C0288, -1220}, {0xBAAEE17FA23EBF76, -1193},
+    {0x8B16FB203055AC76, -1166}, {0xCF42894A5DCE35EA, -1140},
+    {0x9A6BB0AA55653B2D, -1113}, {0xE61ACF033D1A45DF, -1087},
+    {0xAB70FE17C79AC6CA, -1060}, {0xFF77B1FCBEBCDC4F, -1034},
+    {0xBE5691EF416BD60C, -1007}, {0x8DD01FAD907FFC3C, -980},
+    {0xD3515C2831559A83, -954}, {0x9D71AC8FADA6C9B5, -927},
+    {0xEA9C227723EE8BCB, -901}, {0xAECC49914078536D, -874},
+    {0x823C12795DB6CE57, -847}, {0xC21094364DFB5637, -821},
+    {0x9096EA6F3848984F, -794}, {0xD77485CB25823AC7, -768},
+    {0xA086CFCD97BF97F4, -741}, {0xEF340A98172AACE5, -715},
+    {0xB23867FB2A35B28E, -688}, {0x84C8D4DFD2C63F3B, -661},
+    {0xC5DD44271AD3CDBA, -635}, {0x936B9FCEBB25C996, -608},
+    {0xDBAC6C247D62A584, -582}, {0xA3AB66580D5FDAF6, -555},
+    {0xF3E2F893DEC3F126, -529}, {0xB5B5ADA8AAFF80B8, -502},
+    {0x87625F056C7C4A8B, -475}, {0xC9BCFF6034C13053, -449},
+    {0x964E858C91BA2655, -422}, {0xDFF9772470297EBD, -396},
+    {0xA6DFBD9FB8E5B88F, -369}, {0xF8A95FCF88747D94, -343},
+    {0xB94470938FA89BCF, -316}, {0x8A08F0F8BF0F156B, -289},
+    {0xCDB02555653131B6, -263}, {0x993FE2C6D07B7FAC, -236},
+    {0xE45C10C42A2B3B06, -210}, {0xAA242499697392D3, -183},
+    {0xFD87B5F28300CA0E, -157}, {0xBCE5086492111AEB, -130},
+    {0x8CBCCC096F5088CC, -103}, {0xD1B71758E219652C, -77},
+    {0x9C40000000000000, -50}, {0xE8D4A51000000000, -24},
+    {0xAD78EBC5AC620000, 3}, {0x813F3978F8940984, 30},
+    {0xC097CE7BC90715B3, 56}, {0x8F7E32CE7BEA5C70, 83},
+    {0xD5D238A4ABE98068, 109}, {0x9F4F2726179A2245, 136},
+    {0xED63A231D4C4FB27, 162}, {0xB0DE65388CC8ADA8, 189},
+    {0x83C7088E1AAB65DB, 216}, {0xC45D1DF942711D9A, 242},
+    {0x924D692CA61BE758, 269}, {0xDA01EE641A708DEA, 295},
+    {0xA26DA3999AEF774A, 322}, {0xF209787BB47D6B85, 348},
+    {0xB454E4A179DD1877, 375}, {0x865B86925B9BC5C2, 402},
+    {0xC83553C5C8965D3D, 428}, {0x952AB45CFA97A0B3, 455},
+    {0xDE469FBD99A05FE3, 481}, {0xA59BC234DB398C25, 508},
+    {0xF6C69A72A3989F5C, 534}, {0xB7DCBF5354E9BECE, 561},
+    {0x88FCF317F22241E2, 588}, {0xCC20CE9BD35C78A5, 614},
+    {0x98165AF37B2153DF, 641}, {0xE2A0B5DC971F303A, 667},
+    {0xA8D9D1535CE3B396, 694}, {0xFB9B7CD9A4A7443C, 720},
+    {0xBB764C4CA7A44410, 747}, {0x8BAB8EEFB6409C1A, 774},
+    {0xD01FEF10A657842C, 800}, {0x9B10A4E5E9913129, 827},
+    {0xE7109BFBA19C0C9D, 853}, {0xAC2820D9623BF429, 880},
+    {0x80444B5E7AA7CF85, 907}, {0xBF21E44003ACDD2D, 933},
+    {0x8E679C2F5E44FF8F, 960}, {0xD433179D9C8CB841, 986},
+    {0x9E19DB92B4E31BA9, 1013}, {0xEB96BF6EBADF77D9, 1039},
+    {0xAF87023B9BF0EE6B, 1066},
+};
+
+static const uint64_t mml_pow10_u64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+static inline MmlDiyFp mml_diyfp_mul(MmlDiyFp a, MmlDiyFp b)
+{
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    uint64_t h = (uint64_t)(p >> 64);
+    uint64_t l = (uint64_t)p;
+    return (MmlDiyFp){h + (l >> 63), a.e + b.e + 64};
+}
+
+static inline MmlDiyFp mml_diyfp_normalize(MmlDiyFp x)
+{
+    int s = __builtin_clzll(x.f);
+    return (MmlDiyFp){x.f << s, x.e - s};
+}
+
+// Cached power c with -60 <= e + c.e + 64 <= -32; *k is set so that value = digits * 10^k.
+static inline MmlDiyFp mml_cached_power(int e, int *k)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0)
+        ik++;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return mml_cached_pow10[index];
+}
+
+static inline void mml_grisu_round(char *buf, size_t len, uint64_t delta, uint64_t rest,
+                                   uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+// w is the value, lo/hi its boundaries, all normalized to the same exponent.
+static size_t mml_grisu2(MmlDiyFp w, MmlDiyFp lo, MmlDiyFp hi, char *buf, int *k)
+{
+    MmlDiyFp c = mml_cached_power(hi.e, k);
+    MmlDiyFp W = mml_diyfp_mul(w, c);
+    MmlDiyFp Wp = mml_diyfp_mul(hi, c);
+    MmlDiyFp Wm = mml_diyfp_mul(lo, c);
+    Wm.f++;
+    Wp.f--;
+
+    uint64_t delta = Wp.f - Wm.f;
+    int shift = -Wp.e;
+    uint64_t one = (uint64_t)1 << shift;
+    uint64_t wp_w = Wp.f - W.f;
+    uint32_t p1 = (uint32_t)(Wp.f >> shift);
+    uint64_t p2 = Wp.f & (one - 1);
+    size_t len = 0;
+
+    int kappa = 1;
+    while (kappa < 10 && p1 >= mml_pow10_u64[kappa])
+        kappa++;
+
+    while (kappa > 0)
+    {
+        uint32_t div = (uint32_t)mml_pow10_u64[kappa - 1];
+        uint32_t d = p1 / div;
+        p1 %= div;
+        if (d || len)
+            buf[len++] = (char)('0' + d);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << shift) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            mml_grisu_round(buf, len, delta, rest, mml_pow10_u64[kappa] << shift, wp_w);
+            return len;
+        }
+    }
+
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> shift);
+        if (d || len)
+            buf[len++] = (char)('0' + d);
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            mml_grisu_round(buf, len, delta, p2, one, wp_w * mml_pow10_u64[-kappa]);
+            return len;
+        }
+    }
+}
+
+// Lay out digits * 10^k in %g style. Returns the number of bytes written.
+static size_t mml_format_decimal(char *out, const char *digits, size_t len, int k)
+{
+    int x = (int)len + k - 1;
+    size_t pos = 0;
+
+    if (x >= -4 && x < 16)
+    {
+        if (x < 0)
+        {
+            out[pos++] = '0';
+            out[pos++] = '.';
+            for (int i = -1; i > x; i--)
+                out[pos++] = '0';
+            memcpy(out + pos, digits, len);
+            return pos + len;
+        }
+        if ((size_t)x + 1 >= len)
+        {
+            memcpy(out, digits, len);
+            pos = len;
+            for (size_t i = len; i <= (size_t)x; i++)
+                out[pos++] = '0';
+            return pos;
+        }
+        memcpy(out, digits, (size_t)x + 1);
+        pos = (size_t)x + 1;
+        out[pos++] = '.';
+        memcpy(out + pos, digits + x + 1, len - (size_t)x - 1);
+        return pos + len - (size_t)x - 1;
+    }
+
+    out[pos++] = digits[0];
+    if (len > 1)
+    {
+        out[pos++] = '.';
+        memcpy(out + pos, digits + 1, len - 1);
+        pos += len - 1;
+    }
+    out[pos++] = 'e';
+    out[pos++] = x < 0 ? '-' : '+';
+    unsigned ax = (unsigned)(x < 0 ? -x : x);
+    if (ax >= 100)
+        out[pos++] = (char)('0' + ax / 100);
+    out[pos++] = (char)('0' + ax / 10 % 10);
+    out[pos++] = (char)('0' + ax % 10);
+    return pos;
+}
+
+static size_t mml_format_special(char *out, int negative, int is_nan, int is_zero)
+{
+    size_t pos = 0;
+    if (negative && !is_nan)
+        out[pos++] = '-';
+    const char *text = is_nan ? "nan" : is_zero ? "0" : "inf";
+    size_t n = strlen(text);
+    memcpy(out + pos, text, n);
+    return pos + n;
+}
+
+// Writes at most MML_FLOAT_CHARS bytes to out; no terminator.
+static size_t format_double(char *out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int negative = (int)(bits >> 63);
+    uint64_t mant = bits & (((uint64_t)1 << 52) - 1);
+    int biased = (int)((bits >> 52) & 0x7FF);
+
+    if (biased == 0x7FF || (biased == 0 && mant == 0))
+        return mml_format_special(out, negative, biased == 0x7FF && mant != 0, biased == 0);
+
+    MmlDiyFp v = biased ? (MmlDiyFp){mant | ((uint64_t)1 << 52), biased - 1075}
+                        : (MmlDiyFp){mant, -1074};
+    MmlDiyFp hi = mml_diyfp_normalize((MmlDiyFp){(v.f << 1) + 1, v.e - 1});
+    MmlDiyFp lo = (mant == 0 && biased > 1) ? (MmlDiyFp){(v.f << 2) - 1, v.e - 2}
+                                            : (MmlDiyFp){(v.f << 1) - 1, v.e - 1};
+    lo.f <<= lo.e - hi.e;
+    lo.e = hi.e;
+
+    char digits[24];
+    int k;
+    size_t len = mml_grisu2(mml_diyfp_normalize(v), lo, hi, digits, &k);
+    size_t pos = 0;
+    if (negative)
+        out[pos++] = '-';
+    return pos + mml_format_decimal(out + pos, digits, len, k);
+}
+
+static size_t format_float(char *out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int negative = (int)(bits >> 31);
+    uint32_t mant = bits & ((1u << 23) - 1);
+    int biased = (int)((bits >> 23) & 0xFF);
+
+    if (biased == 0xFF || (biased == 0 && mant == 0))
+        return mml_format_special(out, negative, biased == 0xFF && mant != 0, biased == 0);
+
+    MmlDiyFp v = biased ? (MmlDiyFp){mant | (1u << 23), biased - 150} : (MmlDiyFp){mant, -149};
+    MmlDiyFp hi = mml_diyfp_normalize((MmlDiyFp){(v.f << 1) + 1, v.e - 1});
+    MmlDiyFp lo = (mant == 0 && biased > 1) ? (MmlDiyFp){(v.f << 2) - 1, v.e - 2}
+                                            : (MmlDiyFp){(v.f << 1) - 1, v.e - 1};
+    lo.f <<= lo.e - hi.e;
+    lo.e = hi.e;
+
+    char digits[24];
+    int k;
+    size_t len = mml_grisu2(mml_diyfp_normalize(v), lo, hi, digits, &k);
+    size_t pos = 0;
+    if (negative)
+        out[pos++] = '-';
+    return pos + mml_format_decimal(out + pos, digits, len, k);
+}
+
+// Digits are formatted straight into the buffer when there is room for the longest
+// integer; only a nearly full or very small buffer goes through a stack copy.
+FORCE_INLINE static void buffer_put_int(Buffer b, int64_t value, int newline)
+{
+    if (b->length + MML_INT_CHARS + 1 < b->capacity)
+    {
+        b->length += format_int64(b->data + b->length, MML_INT_CHARS, value);
+        if (newline)
+            b->data[b->length++] = '\n';
+        return;
+    }
+
+    char buf[MML_INT_CHARS];
+    buffer_put(b, buf, format_int64(buf, sizeof(buf), value), newline);
+}
+
+FORCE_INLINE void buffer_write_int(Buffer b, int64_t value)
+{
+    if (!b)
+        return;
+    buffer_put_int(b, value, 0);
+}
+
+FORCE_INLINE void buffer_writeln_int(Buffer b, int64_t value)
+{
+    if (!b)
+        return;
+    buffer_put_int(b, value, 1);
+}
+
+FORCE_INLINE void buffer_write_float(Buffer b, float value)
+{
+    if (!b)
+        return;
+    char buf[MML_FLOAT_CHARS];
+    buffer_put(b, buf, format_float(buf, value), 0);
+}
+
+FORCE_INLINE void buffer_writeln_float(Buffer b, float value)
+{
+    if (!b)
+        return;
+    char buf[MML_FLOAT_CHARS];
+    buffer_put(b, buf, format_float(buf, value), 1);
+}
+
+FORCE_INLINE void buffer_write_double(Buffer b, double value)
+{
+    if (!b)
+        return;
+    char buf[MML_FLOAT_CHARS];
+    buffer_put(b, buf, format_double(buf, value), 0);
+}
+
+FORCE_INLINE void buffer_writeln_double(Buffer b, double value)
+{
+    if (!b)
+        return;
+    char buf[MML_FLOAT_CHARS];
+    buffer_put(b, buf, format_double(buf, value), 1);
+}
+
+// --- Input Reader ---
+// Buffered line reader, the input mirror of Buffer: one read() refills up to
+// MML_READER_CAPACITY bytes and lines are cut out of the buffer with memchr, so a line
+// costs one allocation (none when it fits inline) and no per-byte syscalls. A line that
+// spans a refill is assembled in a scratch buffer the reader keeps and reuses. On a
+// non-blocking fd an unfinished line waits in that scratch buffer until its newline
+// arrives, so lines always come back whole. Readers never close their fd.
+
+#define MML_READER_CAPACITY (64 * 1024)
+
+typedef struct
+{
+    int fd;
+    int eof;
+    size_t start; // next unread byte in data
+    size_t end;   // one past the last valid byte in data
+    char *data;
+    char *line; // scratch for lines spanning refills
+    size_t line_cap;
+    size_t pending; // bytes of an unfinished line waiting in line
+} ReaderImpl;
+
+typedef ReaderImpl *Reader;
+
+Reader mkReader(int64_t fd)
+{
+    Reader r = (Reader)malloc(sizeof(ReaderImpl));
+    if (!r)
+        mml_sys_oom_abort();
+    r->fd = (int)fd;
+    r->eof = 0;
+    r->start = 0;
+    r->end = 0;
+    r->data = (char *)malloc(MML_READER_CAPACITY);
+    if (!r->data)
+        mml_sys_oom_abort();
+    r->line = NULL;
+    r->line_cap = 0;
+    r->pending = 0;
+    return r;
+}
+
+static int mml_reader_fill(Reader r)
+{
+    if (r->eof)
+        return 0;
+    if (r->fd == STDIN_FILENO)
+        mml_sys_flush();
+
+    ssize_t n;
+    do
+        n = read(r->fd, r->data, MML_READER_CAPACITY);
+    while (n < 0 && errno == EINTR);
+
+    r->start = 0;
+    if (n <= 0)
+    {
+        // A non-blocking fd with nothing to read yet is not the end of input.
+        r->eof = !(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+        r->end = 0;
+        return 0;
+    }
+    r->end = (size_t)n;
+    return 1;
+}
+
+static void mml_reader_stash(Reader r, const char *src, size_t n, size_t *len)
+{
+    if (*len + n > r->line_cap)
+    {
+        size_t cap = r->line_cap ? r->line_cap : 256;
+        while (*len + n > cap)
+            cap *= 2;
+        char *grown = (char *)realloc(r->line, cap);
+        if (!grown)
+            mml_sys_oom_abort();
+        r->line = grown;
+        r->line_cap = cap;
+    }
+    memcpy(r->line + *len, src, n);
+    *len += n;
+}
+
+// Next line without its trailing newline; an empty String once input is exhausted
+// (use reader_eof to tell that apart from an empty line). When a non-blocking fd has
+// no complete line yet, the bytes read so far are kept for the next call and the
+// result is an empty String; reader_poll says when a line is ready.
+String reader_next_line(Reader r)
+{
+    if (!r)
+        return (String){0, NULL};
+
+    size_t len = r->pending;
+    int spanned = len > 0;
+    r->pending = 0;
+    while (r->start < r->end || mml_reader_fill(r))
+    {
+        char *base = r->data + r->start;
+        size_t avail = r->end - r->start;
+        char *nl = (char *)memchr(base, '\n', avail);
+        if (nl)
+        {
+            size_t n = (size_t)(nl - base);
+            r->start += n + 1;
+            if (!spanned)
+                return mml_str_from(base, n);
+            mml_reader_stash(r, base, n, &len);
+            return mml_str_from(r->line, len);
+        }
+        mml_reader_stash(r, base, avail, &len);
+        spanned = 1;
+        r->start = r->end;
+    }
+    if (!r->eof && len > 0)
+    {
+        r->pending = len;
+        return (String){0, NULL};
+    }
+    return mml_str_from(r->line, len);
+}
+
+// True when no input is left; may block to refill.
+_Bool reader_eof(Reader r)
+{
+    if (!r)
+        return 1;
+    if (r->start < r->end || r->pending > 0)
+        return 0;
+    return !mml_reader_fill(r) && r->eof;
+}
+
+// One read of whatever input is available, keeping unread bytes. Returns true when
+// reader_next_line can now return a whole line without waiting, or the input has
+// ended. Meant for non-blocking fds driven by an EventLoop.
+_Bool reader_poll(Reader r)
+{
+    if (!r)
+        return 1;
+    size_t avail = r->end - r->start;
+    if (r->eof || memchr(r->data + r->start, '\n', avail))
+        return 1;
+    // The unfinished line moves to the scratch buffer, freeing all of data for the read.
+    if (avail > 0)
+        mml_reader_stash(r, r->data + r->start, avail, &r->pending);
+    r->start = 0;
+    r->end = 0;
+    if (r->fd == STDIN_FILENO)
+        mml_sys_flush();
+
+    ssize_t n;
+    do
+        n = read(r->fd, r->data, MML_READER_CAPACITY);
+    while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 0;
+    if (n <= 0)
+    {
+        r->eof = 1;
+        return 1;
+    }
+    r->end = (size_t)n;
+    return memchr(r->data, '\n', (size_t)n) != NULL;
+}
+
+// read_line_fd and readline keep one Reader per descriptor, so consecutive calls share
+// buffered input. Mixing them with read_file on the same fd sees bytes out of order.
+#define MML_READER_FDS 64
+static Reader fd_readers[MML_READER_FDS];
+
+static Reader mml_fd_reader(int fd)
+{
+    if (fd < 0 || fd >= MML_READER_FDS)
+        return NULL;
+    if (!fd_readers[fd])
+        fd_readers[fd] = mkReader(fd);
+    return fd_readers[fd];
+}
+
+// --- Read a line from stdin ---
+String readline()
+{
+    return reader_next_line(mml_fd_reader(STDIN_FILENO));
+}
+
+// --- Print a string (no newline) ---
+void print(String str)
+{
+    buffer_write(get_stdout_buffer(), str);
+}
+
+// --- StringBuilder ---
+typedef struct
+{
+    size_t capacity;
+    size_t length;
+    char *buffer;
+} StringBuilder;
+
+// The buffer is handed to the finalized String, so its capacity is kept at or above the
+// pool size class of any length it can hold: small capacities are rounded up to a class
+// and growth doubles from there.
+StringBuilder *string_builder_new(size_t initial_capacity)
+{
+    StringBuilder *sb = (StringBuilder *)mml_alloc(sizeof(StringBuilder));
+
+    if (initial_capacity <= MML_STR_POOL_MAX)
+        initial_capacity = (size_t)16 << mml_str_class(initial_capacity);
+    sb->buffer = (char *)mml_alloc(initial_capacity);
+
+    sb->capacity = initial_capacity;
+    sb->length = 0;
+    return sb;
+}
+
+StringBuilder *string_builder_append(StringBuilder *sb, String str)
+{
+    size_t len = mml_str_len(&str);
+    if (!sb || len == 0)
+        return sb;
+
+    if (sb->length + len >= sb->capacity)
+    {
+        size_t new_capacity = sb->capacity ? sb->capacity : 16;
+        while (sb->length + len >= new_capacity)
+            new_capacity *= 2;
+        sb->buffer = (char *)mml_realloc(sb->buffer, sb->length, new_capacity);
+        sb->capacity = new_capacity;
+    }
+    memcpy(sb->buffer + sb->length, mml_str_ptr(&str), len);
+    sb->length += len;
+    sb->buffer[sb->length] = '\0';
+    return sb;
+}
+
+String string_builder_finalize(StringBuilder *sb)
+{
+    if (!sb)
+        return (String){0, NULL};
+
+    // Hand the buffer over rather than copying it; short results still move inline.
+    String result = mml_str_adopt(sb->buffer, sb->length);
+    mml_free(sb);
+    return result;
+}
+
+// --- Print a string with newline ---
+void println(String str)
+{
+    buffer_writeln(get_stdout_buffer(), str);
+}
+
+// --- Substring ---
+String substring(String s, size_t start, size_t len)
+{
+    size_t length = mml_str_len(&s);
+    if (start >= length)
+        return (String){0, NULL};
+    if (len > length - start)
+        len = length - start;
+
+    return mml_str_from(mml_str_ptr(&s) + start, len);
+}
+
+// --- Substring View ---
+// Borrowed slice that shares the parent's bytes: no allocation, and never freed.
+// Inline parents live in the caller's copy of the struct, so their slices are copied
+// inline instead of pointing into it.
+String substring_view(String s, int64_t start, int64_t len)
+{
+    size_t length = mml_str_len(&s);
+    if (start < 0 || len <= 0 || (size_t)start >= length)
+        return (String){0, NULL};
+    size_t n = (size_t)len;
+    if (n > length - (size_t)start)
+        n = length - (size_t)start;
+
+    if (mml_str_is_inline(&s))
+        return mml_str_from((const char *)&s + start, n);
+    return (String){n, s.data + start};
+}
+
+int64_t str_len(String s)
+{
+    return (int64_t)mml_str_len(&s);
+}
+
+// --- Free String Memory ---
+void free_string(String str)
+{
+    if (!mml_str_is_inline(&str))
+        mml_str_release(str.data, str.length + 1);
+}
+
+// --- String Concatenation ---
+String concat(String a, String b)
+{
+    size_t a_len = mml_str_len(&a);
+    size_t b_len = mml_str_len(&b);
+
+    // If one string is empty, return a copy of the other
+    if (a_len == 0)
+        return mml_str_from(mml_str_ptr(&b), b_len);
+    if (b_len == 0)
+        return mml_str_from(mml_str_ptr(&a), a_len);
+
+    size_t total_length = a_len + b_len;
+    if (total_length <= MML_SSO_MAX)
+    {
+        char tmp[MML_SSO_MAX + 1];
+        memcpy(tmp, mml_str_ptr(&a), a_len);
+        memcpy(tmp + a_len, mml_str_ptr(&b), b_len);
+        return mml_str_from(tmp, total_length);
+    }
+
+    char *new_data = mml_str_alloc(total_length + 1);
+
+    // Copy both strings
+    memcpy(new_data, mml_str_ptr(&a), a_len);
+    memcpy(new_data + a_len, mml_str_ptr(&b), b_len);
+    new_data[total_length] = '\0';
+
+    return (String){total_length, new_data};
+}
+
+_Bool str_eq(String a, String b)
+{
+    // Inline strings are zero-padded, so two of them compare as whole structs.
+    if (mml_str_is_inline(&a) && mml_str_is_inline(&b))
+        return memcmp(&a, &b, sizeof(String)) == 0;
+
+    size_t len = mml_str_len(&a);
+    if (len != mml_str_len(&b))
+        return 0;
+    if (len == 0)
+        return 1;
+    const char *pa = mml_str_ptr(&a);
+    const char *pb = mml_str_ptr(&b);
+    if (pa == pb)
+        return 1;
+    return mml_kernels.bytes_eq(pa, pb, len);
+}
+
+// --- Integer to String Conversion ---
+String int_to_str(int64_t value)
+{
+    char data[MML_INT_CHARS];
+    return mml_str_from(data, format_int64(data, sizeof(data), value));
+}
+
+// --- Float to String Conversion ---
+String float_to_str(float value)
+{
+    char buf[MML_FLOAT_CHARS];
+    return mml_str_from(buf, format_float(buf, value));
+}
+
+String double_to_str(double value)
+{
+    char buf[MML_FLOAT_CHARS];
+    return mml_str_from(buf, format_double(buf, value));
+}
+
+// --- String to Integer Conversion (strict) ---
+int64_t str_to_int(String s)
+{
+    size_t length = mml_str_len(&s);
+    const char *data = mml_str_ptr(&s);
+    if (length == 0)
+        return 0;
+
+    size_t i = 0;
+    int sign = 1;
+    if (data[0] == '-' || data[0] == '+')
+    {
+        sign = (data[0] == '-') ? -1 : 1;
+        i = 1;
+    }
+
+    if (i >= length)
+        return 0;
+
+    int64_t value = 0;
+    for (; i < length; i++)
+    {
+        char c = data[i];
+        if (c < '0' || c > '9')
+            return 0;
+        value = (value * 10) + (c - '0');
+    }
+
+    return value * sign;
+}
+
+// --- File Handling ---
+
+// Helper: convert MML String to null-terminated C string
+static char *to_cstr(String s)
+{
+    size_t len = mml_str_len(&s);
+    char *cstr = (char *)malloc(len + 1);
+    if (!cstr)
+        mml_sys_oom_abort();
+    if (len)
+        memcpy(cstr, mml_str_ptr(&s), len);
+    cstr[len] = '\0';
+    return cstr;
+}
+
+int open_file(const char *path, const char *mode)
+{
+    int flags = (!strcmp(mode, "r")) ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
+    return open(path, flags, 0644);
+}
+
+int open_file_read(String path)
+{
+    char *cpath = to_cstr(path);
+    if (!cpath)
+        return -1;
+    int fd = open(cpath, O_RDONLY, 0);
+    free(cpath);
+    return fd;
+}
+
+int open_file_write(String path)
+{
+    char *cpath = to_cstr(path);
+    if (!cpath)
+        return -1;
+    int fd = open(cpath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    free(cpath);
+    return fd;
+}
+
+int open_file_append(String path)
+{
+    char *cpath = to_cstr(path);
+    if (!cpath)
+        return -1;
+    int fd = open(cpath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    free(cpath);
+    return fd;
+}
+
+ssize_t read_file(int fd, char *buffer, size_t size)
+{
+    return read(fd, buffer, size);
+}
+
+ssize_t write_file(int fd, const char *buffer, size_t size)
+{
+    MML_STAT_ADD(write_calls, 1);
+    ssize_t n = write(fd, buffer, size);
+    if (n > 0)
+        MML_STAT_ADD(bytes_written, n);
+    return n;
+}
+
+void __free_Reader(Reader r);
+
+void close_file(int fd)
+{
+    if (fd >= 0 && fd < MML_READER_FDS && fd_readers[fd])
+    {
+        __free_Reader(fd_readers[fd]);
+        fd_readers[fd] = NULL;
+    }
+    close(fd);
+}
+
+String read_line_fd(int fd)
+{
+    Reader r = mml_fd_reader(fd);
+    if (r)
+        return reader_next_line(r);
+
+    // Descriptors past the reader table fall back to unbuffered byte reads.
+    size_t size = 1024;
+    size_t len = 0;
+    char *buffer = (char *)mml_alloc(size);
+
+    char c;
+    while (read(fd, &c, 1) == 1 && c != '\n')
+    {
+        if (len + 1 >= size)
+        {
+            buffer = (char *)mml_realloc(buffer, len, size * 2);
+            size *= 2;
+        }
+        buffer[len++] = c;
+    }
+    buffer[len] = '\0';
+    return mml_str_adopt(buffer, len);
+}
+
+// --- Memory-Mapped Files ---
+// A read-only private mapping of a whole file. mapped_as_string returns a borrowed
+// String over the mapping (like substring_view, it is neither copied nor NUL-terminated)
+// that must not outlive the MappedFile; __free_MappedFile unmaps it.
+
+typedef struct
+{
+    char *addr;
+    size_t len;
+    int ok;
+} MappedFileImpl;
+
+typedef MappedFileImpl *MappedFile;
+
+MappedFile mmap_file(String path)
+{
+    MappedFile m = (MappedFile)malloc(sizeof(MappedFileImpl));
+    if (!m)
+        mml_sys_oom_abort();
+    m->addr = NULL;
+    m->len = 0;
+    m->ok = 0;
+
+    char *cpath = to_cstr(path);
+    int fd = open(cpath, O_RDONLY, 0);
+    free(cpath);
+    if (fd < 0)
+        return m;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= 0)
+    {
+        m->len = (size_t)st.st_size;
+        m->ok = 1;
+        // mmap rejects zero-length mappings; an empty file is an empty view.
+        if (m->len > 0)
+        {
+            void *p = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                m->len = 0;
+                m->ok = 0;
+            }
+            else
+            {
+                m->addr = (char *)p;
+                madvise(p, m->len, MADV_SEQUENTIAL);
+            }
+        }
+    }
+    close(fd);
+    return m;
+}
+
+// Size in bytes, or -1 if the file could not be opened or mapped.
+int64_t mapped_len(MappedFile m)
+{
+    if (!m || !m->ok)
+        return -1;
+    return (int64_t)m->len;
+}
+
+String mapped_as_string(MappedFile m)
+{
+    if (!m || !m->addr)
+        return (String){0, NULL};
+    return (String){m->len, m->addr};
+}
+
+// --- Process Execution ---
+// Children start through posix_spawnp. glibc and macOS implement it with
+// vfork/clone(CLONE_VM), so no page tables are copied and spawning from a large process
+// costs no more than from a small one. Exit statuses follow the shell: the child's exit
+// code, 128 + the signal number if it was killed, 127 if it could not be started.
+
+extern char **environ;
+
+static int mml_proc_wait(pid_t pid)
+{
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            return 127;
+    }
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    return 127;
+}
+
+// Start cmd (looked up in PATH) with its stdout on out_fd, or inherited when out_fd < 0.
+static pid_t mml_proc_start(const char *cmd, char *const argv[], int out_fd)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_t *file_actions = NULL;
+    if (out_fd >= 0)
+    {
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+        file_actions = &actions;
+    }
+    pid_t pid;
+    int rc = posix_spawnp(&pid, cmd, file_actions, NULL, argv, environ);
+    if (file_actions)
+        posix_spawn_file_actions_destroy(file_actions);
+    return rc == 0 ? pid : -1;
+}
+
+typedef void (*MmlProcSink)(void *ctx, const char *chunk, size_t len);
+
+// Run cmd with its stdout on a pipe, handing every chunk to sink until EOF, so the
+// child never blocks on a full pipe. Returns -1 if the pipe cannot be created.
+static int mml_proc_capture(const char *cmd, char *const argv[], MmlProcSink sink, void *ctx)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+    // Close-on-exec keeps both ends out of this and any concurrently spawned child;
+    // dup2 onto the child's stdout clears the flag there.
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    pid_t pid = mml_proc_start(cmd, argv, fds[1]);
+    close(fds[1]);
+    if (pid < 0)
+    {
+        close(fds[0]);
+        return 127;
+    }
+    char chunk[16384];
+    for (;;)
+    {
+        ssize_t n = read(fds[0], chunk, sizeof(chunk));
+        if (n > 0)
+            sink(ctx, chunk, (size_t)n);
+        else if (n == 0 || errno != EINTR)
+            break;
+    }
+    close(fds[0]);
+    return mml_proc_wait(pid);
+}
+
+int run_process(const char *cmd, char *const argv[])
+{
+    pid_t pid = mml_proc_start(cmd, argv, -1);
+    return pid < 0 ? 127 : mml_proc_wait(pid);
+}
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t cap; // bytes available for output, excluding the terminator
+} MmlProcBytes;
+
+static void mml_proc_fixed_sink(void *ctx, const char *chunk, size_t len)
+{
+    MmlProcBytes *out = (MmlProcBytes *)ctx;
+    size_t room = out->cap - out->len;
+    size_t n = len < room ? len : room;
+    memcpy(out->data + out->len, chunk, n);
+    out->len += n;
+}
+
+// Up to size - 1 bytes of the child's stdout, NUL-terminated. The rest is read and
+// dropped.
+int run_process_with_output(const char *cmd, char *const argv[], char *output, size_t size)
+{
+    if (!output || size == 0)
+        return -1;
+    MmlProcBytes out = {output, 0, size - 1};
+    int status = mml_proc_capture(cmd, argv, mml_proc_fixed_sink, &out);
+    output[out.len] = '\0';
+    return status;
+}
+
+// NUL-terminated copies of cmd and args as an argv vector, in one malloc block.
+static char **mml_proc_argv(String cmd, StringArray args)
+{
+    int64_t argc = args.data ? args.length : 0;
+    size_t bytes = mml_str_len(&cmd) + 1;
+    for (int64_t i = 0; i < argc; i++)
+        bytes += mml_str_len(&args.data[i]) + 1;
+
+    char **argv = (char **)malloc((size_t)(argc + 2) * sizeof(char *) + bytes);
+    if (!argv)
+        mml_sys_oom_abort();
+    char *p = (char *)(argv + argc + 2);
+    for (int64_t i = -1; i < argc; i++)
+    {
+        const String *s = i < 0 ? &cmd : &args.data[i];
+        size_t len = mml_str_len(s);
+        if (len)
+            memcpy(p, mml_str_ptr(s), len);
+        p[len] = '\0';
+        argv[i + 1] = p;
+        p += len + 1;
+    }
+    argv[argc + 1] = NULL;
+    return argv;
+}
+
+// Run cmd with args, sharing this process's stdout. Output already printed by the
+// calling thread is flushed first so it comes before the child's.
+int64_t run_cmd(String cmd, StringArray args)
+{
+    mml_sys_flush();
+    char **argv = mml_proc_argv(cmd, args);
+    int status = run_process(argv[0], argv);
+    free(argv);
+    return status;
+}
+
+static void mml_proc_buffer_sink(void *ctx, const char *chunk, size_t len)
+{
+    buffer_put((Buffer)ctx, chunk, len, 0);
+}
+
+// Run cmd with args and stream its stdout through b as it arrives.
+int64_t run_cmd_into(String cmd, StringArray args, Buffer b)
+{
+    if (!b)
+        return -1;
+    char **argv = mml_proc_argv(cmd, args);
+    int status = mml_proc_capture(argv[0], argv, mml_proc_buffer_sink, b);
+    free(argv);
+    return status;
+}
+
+static void mml_proc_grow_sink(void *ctx, const char *chunk, size_t len)
+{
+    MmlProcBytes *out = (MmlProcBytes *)ctx;
+    if (out->len + len > out->cap)
+    {
+        size_t cap = out->cap;
+        while (out->len + len > cap)
+            cap *= 2;
+        out->data = (char *)mml_realloc(out->data, out->len, cap + 1);
+        out->cap = cap;
+    }
+    memcpy(out->data + out->len, chunk, len);
+    out->len += len;
+}
+
+// The child's whole stdout as a String. The exit status is dropped; use run_cmd_into
+// when it matters.
+String run_cmd_capture(String cmd, StringArray args)
+{
+    char **argv = mml_proc_argv(cmd, args);
+    // At least the pool's largest class, so the adopted payload is safe to recycle.
+    MmlProcBytes out = {(char *)mml_alloc(4096 + 1), 0, 4096};
+    mml_proc_capture(argv[0], argv, mml_proc_grow_sink, &out);
+    free(argv);
+    out.data[out.len] = '\0';
+    return mml_str_adopt(out.data, out.len);
+}
+
+// --- Event Loop ---
+// Readiness-based loop over non-blocking fds: epoll on Linux, kqueue on macOS and the
+// BSDs (interest changes are queued and submitted in one batch with the next wait), and
+// poll() elsewhere. Watches are level-triggered. ev_wait collects the ready fds, runs
+// any C callback registered with mml_ev_watch, and leaves the list for MML code to read
+// back with ev_ready_fd / ev_ready_events.
+//
+// ev_flush writes what a Buffer's fd accepts now and, if bytes remain, lets the loop
+// finish the flush as the fd becomes writable. Freeing the Buffer or the loop first
+// completes the flush with blocking writes.
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define MML_EV_EPOLL 1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/event.h>
+#define MML_EV_KQUEUE 1
+#endif
+
+#define MML_EV_READ 1
+#define MML_EV_WRITE 2
+
+struct EventLoopImpl;
+typedef void (*MmlEvCallback)(struct EventLoopImpl *loop, int fd, int events, void *ctx);
+
+typedef struct
+{
+    int events; // requested by the user: MML_EV_READ | MML_EV_WRITE
+    int armed;  // registered with the backend (user events plus a pending flush)
+    MmlEvCallback cb;
+    void *ctx;
+    Buffer flush; // Buffer with an ev_flush in progress on this fd
+    int ready_slot; // index into ready, valid when ready_gen matches the loop's
+    unsigned ready_gen;
+} MmlEvWatch;
+
+typedef struct
+{
+    int fd;
+    int events;
+} MmlEvReady;
+
+typedef struct EventLoopImpl
+{
+    int backend; // epoll / kqueue fd; unused by the poll() fallback
+    MmlEvWatch *watches; // indexed by fd
+    int watch_cap;
+    MmlEvReady *ready;
+    int nready;
+    int ready_cap;
+    unsigned gen;
+#if defined(MML_EV_KQUEUE)
+    struct kevent *changes;
+    int nchanges;
+    int changes_cap;
+#endif
+} EventLoopImpl;
+
+typedef EventLoopImpl *EventLoop;
+
+EventLoop ev_new(void)
+{
+    EventLoop loop = (EventLoop)calloc(1, sizeof(EventLoopImpl));
+    if (!loop)
+        mml_sys_oom_abort();
+#if defined(MML_EV_EPOLL)
+    loop->backend = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(MML_EV_KQUEUE)
+    loop->backend = kqueue();
+    if (loop->backend >= 0)
+        fcntl(loop->backend, F_SETFD, FD_CLOEXEC);
+#else
+    loop->backend = -1;
+#endif
+    return loop;
+}
+
+static MmlEvWatch *mml_ev_slot(EventLoop loop, int fd)
+{
+    if (fd >= loop->watch_cap)
+    {
+        int cap = loop->watch_cap ? loop->watch_cap : 64;
+        while (fd >= cap)
+            cap *= 2;
+        MmlEvWatch *grown = (MmlEvWatch *)realloc(loop->watches, (size_t)cap * sizeof(MmlEvWatch));
+        if (!grown)
+            mml_sys_oom_abort();
+        memset(grown + loop->watch_cap, 0, (size_t)(cap - loop->watch_cap) * sizeof(MmlEvWatch));
+        loop->watches = grown;
+        loop->watch_cap = cap;
+    }
+    return &loop->watches[fd];
+}
+
+#if defined(MML_EV_KQUEUE)
+static void mml_ev_queue_change(EventLoop loop, int fd, int filter, int flags)
+{
+    if (loop->nchanges == loop->changes_cap)
+    {
+        int cap = loop->changes_cap ? loop->changes_cap * 2 : 64;
+        struct kevent *grown =
+            (struct kevent *)realloc(loop->changes, (size_t)cap * sizeof(struct kevent));
+        if (!grown)
+            mml_sys_oom_abort();
+        loop->changes = grown;
+        loop->changes_cap = cap;
+    }
+    EV_SET(&loop->changes[loop->nchanges++], fd, filter, flags, 0, 0, NULL);
+}
+#endif
+
+// Bring the backend registration for fd in line with what it needs now.
+static void mml_ev_rearm(EventLoop loop, int fd)
+{
+    MmlEvWatch *w = &loop->watches[fd];
+    int want = w->events | (w->flush ? MML_EV_WRITE : 0);
+    if (want == w->armed)
+        return;
+#if defined(MML_EV_EPOLL)
+    struct epoll_event ev = {0};
+    ev.events = ((want & MML_EV_READ) ? EPOLLIN : 0) | ((want & MML_EV_WRITE) ? EPOLLOUT : 0);
+    ev.data.fd = fd;
+    int op = !w->armed ? EPOLL_CTL_ADD : want ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
+    epoll_ctl(loop->backend, op, fd, &ev);
+#elif defined(MML_EV_KQUEUE)
+    int changed = want ^ w->armed;
+    if (changed & MML_EV_READ)
+        mml_ev_queue_change(loop, fd, EVFILT_READ, (want & MML_EV_READ) ? EV_ADD : EV_DELETE);
+    if (changed & MML_EV_WRITE)
+        mml_ev_queue_change(loop, fd, EVFILT_WRITE, (want & MML_EV_WRITE) ? EV_ADD : EV_DELETE);
+#endif
+    w->armed = want;
+}
+
+// Watch fd for events (MML_EV_READ | MML_EV_WRITE; 0 stops watching). cb, when not
+// NULL, runs from ev_wait for each readiness event.
+void mml_ev_watch(EventLoop loop, int fd, int events, MmlEvCallback cb, void *ctx)
+{
+    if (!loop || fd < 0)
+        return;
+    MmlEvWatch *w = mml_ev_slot(loop, fd);
+    w->events = events & (MML_EV_READ | MML_EV_WRITE);
+    w->cb = events ? cb : NULL;
+    w->ctx = events ? ctx : NULL;
+    mml_ev_rearm(loop, fd);
+}
+
+void ev_watch(EventLoop loop, int64_t fd, int64_t events)
+{
+    mml_ev_watch(loop, (int)fd, (int)events, NULL, NULL);
+}
+
+void ev_unwatch(EventLoop loop, int64_t fd)
+{
+    if (loop && fd >= 0 && fd < loop->watch_cap)
+        mml_ev_watch(loop, (int)fd, 0, NULL, NULL);
+}
+
+// Write what a non-blocking fd accepts without waiting and keep the rest at the front of
+// the buffer. Returns the bytes still pending, or -1 after a write error (they are
+// dropped).
+int64_t buffer_flush_nb(Buffer b)
+{
+    if (!b)
+        return 0;
+    if (b->length)
+        MML_STAT_ADD(flushes, 1);
+    size_t off = 0;
+    while (off < b->length)
+    {
+        ssize_t n = write(b->fd, b->data + off, b->length - off);
+        MML_STAT_ADD(write_calls, 1);
+        if (n > 0)
+            off += (size_t)n;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+        {
+            b->length = 0;
+            return -1;
+        }
+    }
+    if (off)
+    {
+        MML_STAT_ADD(bytes_written, off);
+        memmove(b->data, b->data + off, b->length - off);
+        b->length -= off;
+    }
+    return (int64_t)b->length;
+}
+
+static void mml_ev_detach_flush(Buffer b)
+{
+    EventLoop loop = b->ev_loop;
+    b->ev_loop = NULL;
+    if (b->fd < loop->watch_cap && loop->watches[b->fd].flush == b)
+    {
+        loop->watches[b->fd].flush = NULL;
+        mml_ev_rearm(loop, b->fd);
+    }
+}
+
+// Start flushing b; returns the bytes the loop will still write (or -1 on error). One
+// flush per fd is in flight: a previous buffer on the same fd is finished first.
+int64_t ev_flush(EventLoop loop, Buffer b)
+{
+    if (!loop || !b || b->fd < 0)
+        return b ? buffer_flush_nb(b) : 0;
+    MmlEvWatch *w = mml_ev_slot(loop, b->fd);
+    if (w->flush && w->flush != b)
+    {
+        Buffer previous = w->flush;
+        mml_ev_detach_flush(previous);
+        flush(previous);
+        w = &loop->watches[b->fd];
+    }
+    int64_t left = buffer_flush_nb(b);
+    if (left > 0 && !w->flush)
+    {
+        if (b->ev_loop && b->ev_loop != loop)
+            mml_ev_detach_flush(b);
+        w->flush = b;
+        b->ev_loop = loop;
+        mml_ev_rearm(loop, b->fd);
+    }
+    else if (left <= 0 && w->flush == b)
+        mml_ev_detach_flush(b);
+    return left;
+}
+
+static void mml_ev_push_ready(EventLoop loop, int fd, int events)
+{
+    MmlEvWatch *w = &loop->watches[fd];
+    if (w->ready_gen == loop->gen)
+    {
+        loop->ready[w->ready_slot].events |= events; // kqueue reports filters separately
+        return;
+    }
+    if (loop->nready == loop->ready_cap)
+    {
+        int cap = loop->ready_cap ? loop->ready_cap * 2 : 64;
+        MmlEvReady *grown = (MmlEvReady *)realloc(loop->ready, (size_t)cap * sizeof(MmlEvReady));
+        if (!grown)
+            mml_sys_oom_abort();
+        loop->ready = grown;
+        loop->ready_cap = cap;
+    }
+    w->ready_gen = loop->gen;
+    w->ready_slot = loop->nready;
+    loop->ready[loop->nready++] = (MmlEvReady){fd, events};
+}
+
+static void mml_ev_collect(EventLoop loop, int timeout_ms)
+{
+#if defined(MML_EV_EPOLL)
+    struct epoll_event events[256];
+    int n = epoll_wait(loop->backend, events, 256, timeout_ms);
+    for (int i = 0; i < n; i++)
+    {
+        int fd = events[i].data.fd;
+        uint32_t e = events[i].events;
+        int ready = ((e & EPOLLIN) ? MML_EV_READ : 0) | ((e & EPOLLOUT) ? MML_EV_WRITE : 0);
+        if (e & (EPOLLHUP | EPOLLERR))
+            ready |= loop->watches[fd].armed; // let the reader see EOF or the error
+        mml_ev_push_ready(loop, fd, ready);
+    }
+#elif defined(MML_EV_KQUEUE)
+    struct kevent events[256];
+    struct timespec ts = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L};
+    int n = kevent(loop->backend, loop->changes, loop->nchanges, events, 256,
+                   timeout_ms < 0 ? NULL : &ts);
+    loop->nchanges = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (events[i].flags & EV_ERROR)
+            continue;
+        int fd = (int)events[i].ident;
+        mml_ev_push_ready(loop, fd, events[i].filter == EVFILT_READ ? MML_EV_READ : MML_EV_WRITE);
+    }
+#else
+    struct pollfd *fds = (struct pollfd *)malloc((size_t)(loop->watch_cap + 1) * sizeof(struct pollfd));
+    if (!fds)
+        mml_sys_oom_abort();
+    nfds_t count = 0;
+    for (int fd = 0; fd < loop->watch_cap; fd++)
+    {
+        int armed = loop->watches[fd].armed;
+        if (armed)
+            fds[count++] = (struct pollfd){fd, (short)(((armed & MML_EV_READ) ? POLLIN : 0) |
+                                                       ((armed & MML_EV_WRITE) ? POLLOUT : 0)),
+                                           0};
+    }
+    int n = poll(fds, count, timeout_ms);
+    for (nfds_t i = 0; n > 0 && i < count; i++)
+    {
+        short e = fds[i].revents;
+        if (!e)
+            continue;
+        int ready = ((e & POLLIN) ? MML_EV_READ : 0) | ((e & POLLOUT) ? MML_EV_WRITE : 0);
+        if (e & (POLLHUP | POLLERR))
+            ready |= loop->watches[fds[i].fd].armed;
+        mml_ev_push_ready(loop, fds[i].fd, ready);
+    }
+    free(fds);
+#endif
+}
+
+// Wait up to timeout_ms (-1: no limit) for watched fds to become ready. Pending
+// ev_flush writes are continued, callbacks run, and the number of fds ready for the
+// events the user asked for is returned.
+int64_t ev_wait(EventLoop loop, int64_t timeout_ms)
+{
+    if (!loop)
+        return 0;
+    loop->gen++;
+    loop->nready = 0;
+    mml_ev_collect(loop, (int)timeout_ms);
+
+    int kept = 0;
+    for (int i = 0; i < loop->nready; i++)
+    {
+        MmlEvReady r = loop->ready[i];
+        MmlEvWatch *w = &loop->watches[r.fd];
+        if ((r.events & MML_EV_WRITE) && w->flush)
+        {
+            Buffer b = w->flush;
+            if (buffer_flush_nb(b) <= 0)
+                mml_ev_detach_flush(b);
+            w = &loop->watches[r.fd];
+        }
+        r.events &= w->events;
+        if (!r.events)
+            continue;
+        loop->ready[kept++] = r;
+        if (w->cb)
+            w->cb(loop, r.fd, r.events, w->ctx); // may change watches
+    }
+    loop->nready = kept;
+    return kept;
+}
+
+int64_t ev_ready_fd(EventLoop loop, int64_t i)
+{
+    return loop && i >= 0 && i < loop->nready ? loop->ready[i].fd : -1;
+}
+
+int64_t ev_ready_events(EventLoop loop, int64_t i)
+{
+    return loop && i >= 0 && i < loop->nready ? loop->ready[i].events : 0;
+}
+
+// 0 on success, -1 if fd's flags cannot be changed.
+int64_t set_nonblocking(int64_t fd)
+{
+    int flags = fcntl((int)fd, F_GETFL);
+    if (flags < 0 || fcntl((int)fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return -1;
+    return 0;
+}
+
+// A new pipe as {read fd, write fd}, both close-on-exec; an empty array on failure.
+IntArray open_pipe(void)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return (IntArray){0, NULL};
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    int64_t *data = (int64_t *)mml_alloc(2 * sizeof(int64_t));
+    data[0] = fds[0];
+    data[1] = fds[1];
+    return (IntArray){2, data};
+}
+
+// --- Out-of-Bounds Traps ---
+// Checked accessors are inlined into every call site, so the failure path lives out of
+// line: each site keeps one predicted-not-taken compare and a call, and the
+// fprintf/exit sequence is emitted once, away from the hot code.
+
+MML_COLD_TRAP void mml_oob_trap(const char *kind, int64_t idx, int64_t len)
+{
+    fprintf(stderr, "%s index out of bounds: %lld (length: %lld)\n", kind, (long long)idx,
+            (long long)len);
+    fflush(stderr);
+    exit(1);
+}
+
+MML_COLD_TRAP static void mml_range_trap(const char *kind, int64_t start, int64_t len,
+                                         int64_t length)
+{
+    fprintf(stderr, "%s range out of bounds: [%lld, %lld) (length: %lld)\n", kind,
+            (long long)start, (long long)(start + len), (long long)length);
+    fflush(stderr);
+    exit(1);
+}
+
+// One unsigned compare covers idx < 0 and idx >= length. An array without storage
+// always has length 0, so it fails too.
+#define MML_CHECK_INDEX(kind, arr, idx)                              \
+    do                                                               \
+    {                                                                \
+        if (MML_UNLIKELY((uint64_t)(idx) >= (uint64_t)(arr).length)) \
+            mml_oob_trap(kind, idx, (arr).length);                   \
+    } while (0)
+
+// --- Scalar Array Functions ---
+// One template per element type: Elem is the storage type, Val the type MML passes
+// (narrow integer arrays store Int8/Int32 but read and write Int). Values are
+// truncated on set and sign-extended on get, like a C conversion.
+#define MML_DEFINE_ARRAY(Name, prefix, Elem, Val)                                      \
+    FORCE_INLINE Name ar_##prefix##_new(int64_t size)                                  \
+    {                                                                                  \
+        if (size <= 0)                                                                 \
+            return (Name){0, NULL};                                                    \
+        Elem *storage = (Elem *)mml_alloc((size_t)size * sizeof(Elem));                \
+        return (Name){size, storage};                                                  \
+    }                                                                                  \
+                                                                                       \
+    FORCE_INLINE void ar_##prefix##_set(Name arr, int64_t idx, Val value)              \
+    {                                                                                  \
+        MML_CHECK_INDEX(#Name, arr, idx);                                              \
+        arr.data[idx] = (Elem)value;                                                   \
+    }                                                                                  \
+                                                                                       \
+    FORCE_INLINE void unsafe_ar_##prefix##_set(Name arr, int64_t idx, Val value)       \
+    {                                                                                  \
+        arr.data[idx] = (Elem)value;                                                   \
+    }                                                                                  \
+                                                                                       \
+    FORCE_INLINE Val ar_##prefix##_get(Name arr, int64_t idx)                          \
+    {                                                                                  \
+        MML_CHECK_INDEX(#Name, arr, idx);                                              \
+        return (Val)arr.data[idx];                                                     \
+    }                                                                                  \
+                                                                                       \
+    FORCE_INLINE Val unsafe_ar_##prefix##_get(Name arr, int64_t idx)                   \
+    {                                                                                  \
+        return (Val)arr.data[idx];                                                     \
+    }                                                                                  \
+                                                                                       \
+    FORCE_INLINE int64_t ar_##prefix##_len(Name arr)                                   \
+    {                                                                                  \
+        return arr.length;                                                             \
+    }                                                                                  \
+                                                                                       \
+    void __free_##Name(Name arr)                                                       \
+    {                                                                                  \
+        MML_STAT_FREE(Name);                                                           \
+        if (arr.data)                                                                  \
+            mml_free(arr.data);                                                        \
+    }                                                                                  \
+                                                                                       \
+    Name __clone_##Name(Name arr)                                                      \
+    {                                                                                  \
+        MML_STAT_CLONE(Name, arr.length > 0 ? (size_t)arr.length * sizeof(Elem) : 0);  \
+        if (!arr.data || arr.length <= 0)                                              \
+            return (Name){0, NULL};                                                    \
+        Elem *new_data = (Elem *)mml_alloc((size_t)arr.length * sizeof(Elem));         \
+        memcpy(new_data, arr.data, (size_t)arr.length * sizeof(Elem));                 \
+        return (Name){arr.length, new_data};                                           \
+    }
+
+MML_DEFINE_ARRAY(IntArray, int, int64_t, int64_t)
+MML_DEFINE_ARRAY(FloatArray, float, float, float)
+MML_DEFINE_ARRAY(Int8Array, i8, int8_t, int64_t)
+MML_DEFINE_ARRAY(Int32Array, i32, int32_t, int64_t)
+MML_DEFINE_ARRAY(DoubleArray, double, double, double)
+
+// --- StringArray Functions ---
+FORCE_INLINE StringArray ar_str_new(int64_t size)
+{
+    if (size <= 0)
+        return (StringArray){0, NULL};
+
+    // Zeroed so that slots never written are skipped by __free_StringArray.
+    String *storage = (String *)mml_alloc((size_t)size * sizeof(String));
+    memset(storage, 0, (size_t)size * sizeof(String));
+
+    return (StringArray){size, storage};
+}
+
+FORCE_INLINE void ar_str_set(StringArray arr, int64_t idx, String value)
+{
+    MML_CHECK_INDEX("StringArray", arr, idx);
+    arr.data[idx] = value;
+}
+
+FORCE_INLINE String ar_str_get(StringArray arr, int64_t idx)
+{
+    MML_CHECK_INDEX("StringArray", arr, idx);
+    return arr.data[idx];
+}
+
+FORCE_INLINE int64_t ar_str_len(StringArray arr)
+{
+    return arr.length;
+}
+
+// --- Hash Maps and Sets ---
+// IntMap (Int -> Int), StringMap (String -> Int) and StringSet are open-addressing Swiss
+// tables. Each slot has a control byte: 0x80 when empty, 0xFE for a deleted entry, or
+// the low 7 bits of the key's hash when full. A lookup hashes the key once, then checks
+// 16 control bytes at a time (one SSE2 or NEON compare) for that 7-bit tag and compares
+// keys only on a tag hit; a group with an empty byte ends the probe. Groups are visited
+// in triangular order, which reaches every group of a power-of-two table, and the table
+// grows at 7/8 load. String keys are copied into the table, so callers only lend them.
+// Table storage comes from malloc, like a Buffer's, so a table that grows inside a
+// region stays valid after it. Iteration order (the *_keys / sset_items arrays) is
+// unspecified.
+
+#define MML_MAP_GROUP 16
+#define MML_CTRL_EMPTY ((uint8_t)0x80)
+#define MML_CTRL_DELETED ((uint8_t)0xFE)
+
+// wyhash constants and mixing (public domain, Wang Yi).
+#define MML_HASH_P0 0xa0761d6478bd642fULL
+#define MML_HASH_P1 0xe7037ed1a0b428dbULL
+#define MML_HASH_P2 0x8ebc6af09c88c6e3ULL
+#define MML_HASH_P3 0x589965cc75374cc3ULL
+
+static inline void mml_mum128(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline uint64_t mml_mix(uint64_t a, uint64_t b)
+{
+    mml_mum128(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t mml_read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t mml_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint64_t mml_hash_bytes(const char *key, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t seed = mml_mix(MML_HASH_P0, MML_HASH_P1);
+    uint64_t a, b;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            size_t mid = (len >> 3) << 2;
+            a = (mml_read32(p) << 32) | mml_read32(p + mid);
+            b = (mml_read32(p + len - 4) << 32) | mml_read32(p + len - 4 - mid);
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        size_t i = len;
+        if (i > 48)
+        {
+            uint64_t s1 = seed, s2 = seed;
+            do
+            {
+                seed = mml_mix(mml_read64(p) ^ MML_HASH_P1, mml_read64(p + 8) ^ seed);
+                s1 = mml_mix(mml_read64(p + 16) ^ MML_HASH_P2, mml_read64(p + 24) ^ s1);
+                s2 = mml_mix(mml_read64(p + 32) ^ MML_HASH_P3, mml_read64(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= s1 ^ s2;
+        }
+        for (; i > 16; i -= 16, p += 16)
+            seed = mml_mix(mml_read64(p) ^ MML_HASH_P1, mml_read64(p + 8) ^ seed);
+        a = mml_read64(p + i - 16);
+        b = mml_read64(p + i - 8);
+    }
+    a ^= MML_HASH_P1;
+    b ^= seed;
+    mml_mum128(&a, &b);
+    return mml_mix(a ^ MML_HASH_P0 ^ len, b ^ MML_HASH_P1);
 }
 
-// --- String Concatenation ---
-String concat(String a, String b)
+static inline uint64_t mml_hash_int(int64_t key)
 {
-    // Return empty string if either input is invalid
-    if (!a.data && !b.data)
-        return (String){0, NULL};
+    return mml_mix((uint64_t)key ^ MML_HASH_P0, MML_HASH_P1);
+}
 
-    // If one string is empty, return a copy of the other
-    if (!a.data)
-        return substring(b, 0, b.length);
-    if (!b.data)
-        return substring(a, 0, a.length);
-
-    // Allocate memory for the combined string
-    size_t total_length = a.length + b.length;
-    char *new_data = (char *)malloc(total_length + 1);
-    if (!new_data)
+static inline uint64_t mml_hash_str(const String *s)
+{
+    return mml_hash_bytes(mml_str_ptr(s), mml_str_len(s));
+}
+
+// Group scans return one bit per matching control byte at bit (i << MML_GROUP_SHIFT), so
+// mml_group_index turns the lowest set bit back into a byte offset and `m &= m - 1` steps
+// to the next match.
+#if defined(__SSE2__)
+#define MML_GROUP_SHIFT 0
+
+static inline uint64_t mml_group_match(const uint8_t *g, uint8_t tag)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+}
+
+// Empty and deleted are the only control bytes with the top bit set.
+static inline uint64_t mml_group_free(const uint8_t *g)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MML_GROUP_SHIFT 2
+
+// NEON has no movemask: narrowing each 16-bit lane by 4 leaves one nibble per byte.
+static inline uint64_t mml_neon_mask(uint8x16_t lanes)
+{
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ULL;
+}
+
+static inline uint64_t mml_group_match(const uint8_t *g, uint8_t tag)
+{
+    return mml_neon_mask(vceqq_u8(vld1q_u8(g), vdupq_n_u8(tag)));
+}
+
+static inline uint64_t mml_group_free(const uint8_t *g)
+{
+    return mml_neon_mask(vcltzq_s8(vreinterpretq_s8_u8(vld1q_u8(g))));
+}
+#else
+#define MML_GROUP_SHIFT 0
+
+static inline uint64_t mml_group_match(const uint8_t *g, uint8_t tag)
+{
+    uint64_t m = 0;
+    for (int i = 0; i < MML_MAP_GROUP; i++)
+        m |= (uint64_t)(g[i] == tag) << i;
+    return m;
+}
+
+static inline uint64_t mml_group_free(const uint8_t *g)
+{
+    uint64_t m = 0;
+    for (int i = 0; i < MML_MAP_GROUP; i++)
+        m |= (uint64_t)(g[i] >> 7) << i;
+    return m;
+}
+#endif
+
+static inline uint64_t mml_group_empty(const uint8_t *g)
+{
+    return mml_group_match(g, MML_CTRL_EMPTY);
+}
+
+static inline size_t mml_group_index(uint64_t m)
+{
+    return (size_t)__builtin_ctzll(m) >> MML_GROUP_SHIFT;
+}
+
+static inline size_t mml_group_last(uint64_t m)
+{
+    return (size_t)(63 - __builtin_clzll(m)) >> MML_GROUP_SHIFT;
+}
+
+enum
+{
+    MML_TABLE_INT_MAP,
+    MML_TABLE_STRING_MAP,
+    MML_TABLE_STRING_SET
+};
+
+typedef struct
+{
+    int64_t key;
+    int64_t value;
+} MmlIntSlot;
+
+// StringSet uses the same slot and ignores the value.
+typedef struct
+{
+    String key;
+    int64_t value;
+} MmlStrSlot;
+
+typedef struct
+{
+    uint8_t *ctrl;      // capacity + MML_MAP_GROUP bytes; the tail mirrors the first group
+    char *slots;        // capacity slots, in the same allocation as ctrl
+    size_t capacity;    // 0 or a power of two >= MML_MAP_GROUP
+    size_t len;
+    size_t growth_left; // inserts into empty slots left before the table must grow
+    uint32_t slot_size;
+    int kind;
+} MmlTable;
+
+typedef MmlTable *IntMap;
+typedef MmlTable *StringMap;
+typedef MmlTable *StringSet;
+
+typedef int (*MmlSlotEq)(const char *slot, const void *key);
+
+static int mml_int_slot_eq(const char *slot, const void *key)
+{
+    return ((const MmlIntSlot *)slot)->key == *(const int64_t *)key;
+}
+
+static int mml_str_slot_eq(const char *slot, const void *key)
+{
+    const String *a = &((const MmlStrSlot *)slot)->key;
+    const String *b = (const String *)key;
+    size_t n = mml_str_len(a);
+    return n == mml_str_len(b) && (n == 0 || memcmp(mml_str_ptr(a), mml_str_ptr(b), n) == 0);
+}
+
+// Table-owned copy of a key: inline when it fits, otherwise plain malloc, never the
+// string pool or a region.
+static String mml_table_key_copy(String key)
+{
+    if (mml_str_is_inline(&key))
+        return key;
+    if (key.length <= MML_SSO_MAX || key.length == 0)
+        return mml_str_from(key.data, key.length);
+    char *data = (char *)malloc(key.length + 1);
+    if (!data)
         mml_sys_oom_abort();
+    memcpy(data, key.data, key.length);
+    data[key.length] = '\0';
+    return (String){key.length, data};
+}
 
-    // Copy both strings
-    memcpy(new_data, a.data, a.length);
-    memcpy(new_data + a.length, b.data, b.length);
-    new_data[total_length] = '\0';
+static inline char *mml_table_slot(const MmlTable *t, size_t i)
+{
+    return t->slots + i * t->slot_size;
+}
 
-    return (String){total_length, new_data};
+static inline uint64_t mml_table_slot_hash(const MmlTable *t, const char *slot)
+{
+    if (t->kind == MML_TABLE_INT_MAP)
+        return mml_hash_int(((const MmlIntSlot *)slot)->key);
+    return mml_hash_str(&((const MmlStrSlot *)slot)->key);
 }
 
-_Bool str_eq(String a, String b)
+static inline void mml_table_set_ctrl(MmlTable *t, size_t i, uint8_t c)
 {
-    if (a.length != b.length)
-        return 0;
-    if (a.length == 0)
-        return 1;
-    if (a.data == b.data)
-        return 1;
-    if (!a.data || !b.data)
-        return 0;
-    return memcmp(a.data, b.data, a.length) == 0;
+    t->ctrl[i] = c;
+    if (i < MML_MAP_GROUP)
+        t->ctrl[t->capacity + i] = c;
 }
 
-// --- Integer to String Conversion ---
-String int_to_str(int64_t value)
+static MmlTable *mml_table_new(int kind)
+{
+    MmlTable *t = (MmlTable *)malloc(sizeof(MmlTable));
+    if (!t)
+        mml_sys_oom_abort();
+    memset(t, 0, sizeof(*t));
+    t->kind = kind;
+    t->slot_size = kind == MML_TABLE_INT_MAP ? sizeof(MmlIntSlot) : sizeof(MmlStrSlot);
+    return t;
+}
+
+static inline size_t mml_table_bytes(const MmlTable *t)
+{
+    return t->capacity ? t->capacity + MML_MAP_GROUP + t->capacity * t->slot_size : 0;
+}
+
+static void mml_table_alloc(MmlTable *t, size_t capacity)
 {
-    // Handle special case of 0
-    if (value == 0)
+    t->capacity = capacity;
+    char *mem = (char *)malloc(mml_table_bytes(t));
+    if (!mem)
+        mml_sys_oom_abort();
+    t->ctrl = (uint8_t *)mem;
+    t->slots = mem + capacity + MML_MAP_GROUP;
+    memset(t->ctrl, MML_CTRL_EMPTY, capacity + MML_MAP_GROUP);
+    t->len = 0;
+    t->growth_left = capacity - capacity / 8;
+}
+
+// Slot index of key, or -1.
+static inline int64_t mml_table_find(const MmlTable *t, uint64_t hash, const void *key,
+                                     MmlSlotEq eq)
+{
+    if (t->capacity == 0)
+        return -1;
+    size_t mask = t->capacity - 1, pos = (size_t)(hash >> 7) & mask, stride = 0;
+    uint8_t tag = (uint8_t)(hash & 0x7F);
+    for (;;)
     {
-        char *data = (char *)malloc(2);
-        if (!data)
-            mml_sys_oom_abort();
-        data[0] = '0';
-        data[1] = '\0';
-        return (String){1, data};
+        const uint8_t *g = t->ctrl + pos;
+        for (uint64_t m = mml_group_match(g, tag); m; m &= m - 1)
+        {
+            size_t i = (pos + mml_group_index(m)) & mask;
+            if (eq(mml_table_slot(t, i), key))
+                return (int64_t)i;
+        }
+        if (mml_group_empty(g))
+            return -1;
+        stride += MML_MAP_GROUP;
+        pos = (pos + stride) & mask;
+    }
+}
+
+// First empty or deleted slot on hash's probe path. Growth keeps 1/8 of the slots empty,
+// so there always is one.
+static inline size_t mml_table_free_slot(const MmlTable *t, uint64_t hash)
+{
+    size_t mask = t->capacity - 1, pos = (size_t)(hash >> 7) & mask, stride = 0;
+    for (;;)
+    {
+        uint64_t m = mml_group_free(t->ctrl + pos);
+        if (m)
+            return (pos + mml_group_index(m)) & mask;
+        stride += MML_MAP_GROUP;
+        pos = (pos + stride) & mask;
+    }
+}
+
+// Doubles the table, or rebuilds it at the same size when at least half of the used
+// slots are tombstones. Slots move by memcpy; keys are not copied again.
+static void mml_table_rehash(MmlTable *t)
+{
+    MmlTable old = *t;
+    if (old.capacity == 0)
+        mml_table_alloc(t, MML_MAP_GROUP);
+    else if (old.len < old.capacity / 16 * 7)
+        mml_table_alloc(t, old.capacity);
+    else
+        mml_table_alloc(t, old.capacity * 2);
+    for (size_t i = 0; i < old.capacity; i++)
+    {
+        if (old.ctrl[i] & 0x80)
+            continue;
+        const char *src = mml_table_slot(&old, i);
+        uint64_t hash = mml_table_slot_hash(t, src);
+        size_t j = mml_table_free_slot(t, hash);
+        mml_table_set_ctrl(t, j, (uint8_t)(hash & 0x7F));
+        memcpy(mml_table_slot(t, j), src, t->slot_size);
     }
+    t->len = old.len;
+    t->growth_left -= old.len;
+    free(old.ctrl);
+}
 
-    // Determine sign and make value positive for processing
-    int is_negative = (value < 0);
-    int64_t abs_value = is_negative ? -value : value;
+// Slot for key, claimed and tagged if the key is new (then *added is 1 and the caller
+// fills the slot).
+static char *mml_table_upsert(MmlTable *t, uint64_t hash, const void *key, MmlSlotEq eq,
+                              int *added)
+{
+    int64_t found = mml_table_find(t, hash, key, eq);
+    if (found >= 0)
+    {
+        *added = 0;
+        return mml_table_slot(t, (size_t)found);
+    }
+    size_t i = t->capacity ? mml_table_free_slot(t, hash) : 0;
+    if (t->capacity == 0 || (t->growth_left == 0 && t->ctrl[i] == MML_CTRL_EMPTY))
+    {
+        mml_table_rehash(t);
+        i = mml_table_free_slot(t, hash);
+    }
+    if (t->ctrl[i] == MML_CTRL_EMPTY)
+        t->growth_left--;
+    mml_table_set_ctrl(t, i, (uint8_t)(hash & 0x7F));
+    t->len++;
+    *added = 1;
+    return mml_table_slot(t, i);
+}
 
-    // Calculate number of digits needed
-    int digit_count = 0;
-    int64_t temp = abs_value;
-    while (temp > 0)
+// A slot can go back to empty if no probe can have passed over it, i.e. the run of full
+// slots through i is shorter than a group; otherwise it stays a tombstone.
+static void mml_table_erase(MmlTable *t, size_t i)
+{
+    size_t mask = t->capacity - 1;
+    uint64_t before = mml_group_empty(t->ctrl + ((i - MML_MAP_GROUP) & mask));
+    uint64_t after = mml_group_empty(t->ctrl + i);
+    size_t full_before = before ? MML_MAP_GROUP - 1 - mml_group_last(before) : MML_MAP_GROUP;
+    size_t full_after = after ? mml_group_index(after) : MML_MAP_GROUP;
+    if (full_before + full_after < MML_MAP_GROUP)
     {
-        digit_count++;
-        temp /= 10;
+        mml_table_set_ctrl(t, i, MML_CTRL_EMPTY);
+        t->growth_left++;
     }
+    else
+        mml_table_set_ctrl(t, i, MML_CTRL_DELETED);
+    t->len--;
+}
 
-    // Allocate memory: digits + potential minus sign + null terminator
-    size_t total_length = digit_count + (is_negative ? 1 : 0);
-    char *data = (char *)malloc(total_length + 1);
-    if (!data)
+static void mml_table_release(MmlTable *t)
+{
+    for (size_t i = 0; t->kind != MML_TABLE_INT_MAP && i < t->capacity; i++)
+    {
+        if (t->ctrl[i] & 0x80)
+            continue;
+        String key = ((MmlStrSlot *)mml_table_slot(t, i))->key;
+        if (!mml_str_is_inline(&key))
+            free(key.data);
+    }
+    free(t->ctrl);
+    free(t);
+}
+
+// One memcpy for control bytes and slots, then fresh copies of any string keys.
+static MmlTable *mml_table_clone(const MmlTable *t)
+{
+    MmlTable *copy = mml_table_new(t->kind);
+    if (t->capacity == 0)
+        return copy;
+    *copy = *t;
+    char *mem = (char *)malloc(mml_table_bytes(t));
+    if (!mem)
         mml_sys_oom_abort();
+    memcpy(mem, t->ctrl, mml_table_bytes(t));
+    copy->ctrl = (uint8_t *)mem;
+    copy->slots = mem + t->capacity + MML_MAP_GROUP;
+    for (size_t i = 0; t->kind != MML_TABLE_INT_MAP && i < t->capacity; i++)
+    {
+        if (copy->ctrl[i] & 0x80)
+            continue;
+        MmlStrSlot *slot = (MmlStrSlot *)mml_table_slot(copy, i);
+        slot->key = mml_table_key_copy(slot->key);
+    }
+    return copy;
+}
+
+static inline int64_t mml_table_len(const MmlTable *t)
+{
+    return t ? (int64_t)t->len : 0;
+}
+
+// Keys of a string table as a new StringArray of owned copies.
+static StringArray mml_table_str_keys(const MmlTable *t)
+{
+    StringArray arr = ar_str_new(mml_table_len(t));
+    int64_t n = 0;
+    for (size_t i = 0; t && i < t->capacity; i++)
+    {
+        if (t->ctrl[i] & 0x80)
+            continue;
+        const String *key = &((const MmlStrSlot *)mml_table_slot(t, i))->key;
+        arr.data[n++] = mml_str_from(mml_str_ptr(key), mml_str_len(key));
+    }
+    return arr;
+}
 
-    // Fill in digits from right to left
-    data[total_length] = '\0';
-    int pos = total_length - 1;
-    while (abs_value > 0)
+IntMap imap_new(void)
+{
+    return mml_table_new(MML_TABLE_INT_MAP);
+}
+
+void imap_put(IntMap m, int64_t key, int64_t value)
+{
+    int added;
+    MmlIntSlot *slot =
+        (MmlIntSlot *)mml_table_upsert(m, mml_hash_int(key), &key, mml_int_slot_eq, &added);
+    slot->key = key;
+    slot->value = value;
+}
+
+// Value for key, or missing when the key is absent.
+int64_t imap_get(IntMap m, int64_t key, int64_t missing)
+{
+    int64_t i = mml_table_find(m, mml_hash_int(key), &key, mml_int_slot_eq);
+    return i < 0 ? missing : ((MmlIntSlot *)mml_table_slot(m, (size_t)i))->value;
+}
+
+_Bool imap_has(IntMap m, int64_t key)
+{
+    return mml_table_find(m, mml_hash_int(key), &key, mml_int_slot_eq) >= 0;
+}
+
+// Adds delta to the value for key; absent keys start at 0.
+void imap_add(IntMap m, int64_t key, int64_t delta)
+{
+    int added;
+    MmlIntSlot *slot =
+        (MmlIntSlot *)mml_table_upsert(m, mml_hash_int(key), &key, mml_int_slot_eq, &added);
+    if (added)
     {
-        data[pos--] = '0' + (abs_value % 10);
-        abs_value /= 10;
+        slot->key = key;
+        slot->value = 0;
     }
+    slot->value = (int64_t)((uint64_t)slot->value + (uint64_t)delta);
+}
+
+void imap_remove(IntMap m, int64_t key)
+{
+    int64_t i = mml_table_find(m, mml_hash_int(key), &key, mml_int_slot_eq);
+    if (i >= 0)
+        mml_table_erase(m, (size_t)i);
+}
 
-    // Add minus sign if negative
-    if (is_negative)
-        data[0] = '-';
+int64_t imap_len(IntMap m)
+{
+    return mml_table_len(m);
+}
 
-    return (String){total_length, data};
+IntArray imap_keys(IntMap m)
+{
+    IntArray arr = ar_int_new(mml_table_len(m));
+    int64_t n = 0;
+    for (size_t i = 0; m && i < m->capacity; i++)
+        if (!(m->ctrl[i] & 0x80))
+            arr.data[n++] = ((MmlIntSlot *)mml_table_slot(m, i))->key;
+    return arr;
 }
 
-// --- Float to String Conversion ---
-String float_to_str(float value)
+StringMap smap_new(void)
+{
+    return mml_table_new(MML_TABLE_STRING_MAP);
+}
+
+static MmlStrSlot *mml_smap_upsert(StringMap m, String key)
 {
-    char buf[32];
-    int len = snprintf(buf, sizeof(buf), "%g", (double)value);
-    if (len <= 0)
+    int added;
+    MmlStrSlot *slot =
+        (MmlStrSlot *)mml_table_upsert(m, mml_hash_str(&key), &key, mml_str_slot_eq, &added);
+    if (added)
     {
-        char *data = (char *)malloc(2);
-        if (!data)
-            mml_sys_oom_abort();
-        data[0] = '0';
-        data[1] = '\0';
-        return (String){1, data};
+        slot->key = mml_table_key_copy(key);
+        slot->value = 0;
     }
-    char *data = (char *)malloc(len + 1);
-    if (!data)
-        mml_sys_oom_abort();
-    memcpy(data, buf, len + 1);
-    return (String){(size_t)len, data};
+    return slot;
+}
+
+void smap_put(StringMap m, String key, int64_t value)
+{
+    mml_smap_upsert(m, key)->value = value;
+}
+
+int64_t smap_get(StringMap m, String key, int64_t missing)
+{
+    int64_t i = mml_table_find(m, mml_hash_str(&key), &key, mml_str_slot_eq);
+    return i < 0 ? missing : ((MmlStrSlot *)mml_table_slot(m, (size_t)i))->value;
+}
+
+_Bool smap_has(StringMap m, String key)
+{
+    return mml_table_find(m, mml_hash_str(&key), &key, mml_str_slot_eq) >= 0;
+}
+
+void smap_add(StringMap m, String key, int64_t delta)
+{
+    MmlStrSlot *slot = mml_smap_upsert(m, key);
+    slot->value = (int64_t)((uint64_t)slot->value + (uint64_t)delta);
+}
+
+static void mml_str_table_remove(MmlTable *t, String key)
+{
+    int64_t i = mml_table_find(t, mml_hash_str(&key), &key, mml_str_slot_eq);
+    if (i < 0)
+        return;
+    String stored = ((MmlStrSlot *)mml_table_slot(t, (size_t)i))->key;
+    if (!mml_str_is_inline(&stored))
+        free(stored.data);
+    mml_table_erase(t, (size_t)i);
+}
+
+void smap_remove(StringMap m, String key)
+{
+    mml_str_table_remove(m, key);
+}
+
+int64_t smap_len(StringMap m)
+{
+    return mml_table_len(m);
+}
+
+StringArray smap_keys(StringMap m)
+{
+    return mml_table_str_keys(m);
+}
+
+StringSet sset_new(void)
+{
+    return mml_table_new(MML_TABLE_STRING_SET);
+}
+
+void sset_add(StringSet s, String key)
+{
+    int added;
+    MmlStrSlot *slot =
+        (MmlStrSlot *)mml_table_upsert(s, mml_hash_str(&key), &key, mml_str_slot_eq, &added);
+    if (added)
+    {
+        slot->key = mml_table_key_copy(key);
+        slot->value = 0;
+    }
+}
+
+_Bool sset_has(StringSet s, String key)
+{
+    return mml_table_find(s, mml_hash_str(&key), &key, mml_str_slot_eq) >= 0;
+}
+
+void sset_remove(StringSet s, String key)
+{
+    mml_str_table_remove(s, key);
+}
+
+int64_t sset_len(StringSet s)
+{
+    return mml_table_len(s);
+}
+
+StringArray sset_items(StringSet s)
+{
+    return mml_table_str_keys(s);
+}
+
+// --- Bulk Array Kernels ---
+// Whole-array loops that the loop vectorizer would otherwise have to recover from
+// tail-recursive get/set calls. The loops themselves live with the CPU dispatch table
+// (see "SIMD Kernels"). Sums and counts wrap like Int arithmetic. Float reductions add
+// in a different order than a sequential loop, so results may differ in the last bits.
+
+static inline int mml_range_ok(int64_t start, int64_t len, int64_t length)
+{
+    return start >= 0 && len >= 0 && start <= length && len <= length - start;
+}
+
+// Set every element of arr to value.
+void ar_int_fill(IntArray arr, int64_t value)
+{
+    if (arr.data)
+        mml_kernels.fill_i64(arr.data, (size_t)arr.length, value);
+}
+
+// Copy len elements of src starting at src_start into dst at dst_start. The ranges may
+// overlap (dst and src can be the same array).
+void ar_int_copy_range(IntArray dst, int64_t dst_start, IntArray src, int64_t src_start,
+                       int64_t len)
+{
+    if (MML_UNLIKELY(!mml_range_ok(dst_start, len, dst.length)))
+        mml_range_trap("IntArray", dst_start, len, dst.length);
+    if (MML_UNLIKELY(!mml_range_ok(src_start, len, src.length)))
+        mml_range_trap("IntArray", src_start, len, src.length);
+    if (len > 0)
+        memmove(dst.data + dst_start, src.data + src_start, (size_t)len * sizeof(int64_t));
+}
+
+int64_t ar_int_sum(IntArray arr)
+{
+    return arr.data ? mml_kernels.sum_i64(arr.data, (size_t)arr.length) : 0;
+}
+
+// Number of elements equal to value.
+int64_t ar_int_count_eq(IntArray arr, int64_t value)
+{
+    return arr.data ? mml_kernels.count_eq_i64(arr.data, (size_t)arr.length, value) : 0;
+}
+
+float ar_float_dot(FloatArray a, FloatArray b)
+{
+    if (MML_UNLIKELY(a.length != b.length))
+        mml_range_trap("FloatArray", 0, b.length, a.length);
+    return a.data ? mml_kernels.dot_f32(a.data, b.data, (size_t)a.length) : 0.0f;
+}
+
+// y = y + alpha * x, in place.
+void ar_float_axpy(float alpha, FloatArray x, FloatArray y)
+{
+    if (MML_UNLIKELY(x.length != y.length))
+        mml_range_trap("FloatArray", 0, x.length, y.length);
+    if (x.data)
+        mml_kernels.axpy_f32(alpha, x.data, y.data, (size_t)x.length);
+}
+
+// --- Sorting and Searching ---
+// Int and Float arrays are sorted with an LSD radix sort: one counting pass builds all
+// byte histograms, then each scatter pass moves the keys into a scratch buffer and back.
+// A pass is skipped when every key has the same byte there, so small-range keys take
+// only a few passes. Short arrays, and strings, go through an introsort: median-of-three
+// quicksort with a Hoare partition, insertion sort for short runs, and heapsort once the
+// recursion gets too deep. None of the sorts allocate MML values.
+
+#define MML_SORT_INSERTION 24
+#define MML_RADIX_MIN 1024
+
+// Introsort on T[] ordered by LESS(a, b). Hoare's partition stops on keys equal to the
+// pivot from both sides, which keeps arrays with many duplicates balanced.
+#define MML_DEFINE_SORT(name, T, LESS)                                                 \
+    static void name##_insertion(T *a, size_t n)                                       \
+    {                                                                                  \
+        for (size_t i = 1; i < n; i++)                                                 \
+        {                                                                              \
+            T x = a[i];                                                                \
+            size_t j = i;                                                              \
+            for (; j > 0 && LESS(x, a[j - 1]); j--)                                    \
+                a[j] = a[j - 1];                                                       \
+            a[j] = x;                                                                  \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_sift(T *a, size_t root, size_t n)                               \
+    {                                                                                  \
+        T x = a[root];                                                                 \
+        for (size_t child; (child = 2 * root + 1) < n; root = child)                   \
+        {                                                                              \
+            if (child + 1 < n && LESS(a[child], a[child + 1]))                         \
+                child++;                                                               \
+            if (!LESS(x, a[child]))                                                    \
+                break;                                                                 \
+            a[root] = a[child];                                                        \
+        }                                                                              \
+        a[root] = x;                                                                   \
+    }                                                                                  \
+                                                                                       \
+    static void name##_heapsort(T *a, size_t n)                                        \
+    {                                                                                  \
+        for (size_t i = n / 2; i-- > 0;)                                               \
+            name##_sift(a, i, n);                                                      \
+        for (size_t end = n; end-- > 1;)                                               \
+        {                                                                              \
+            T top = a[0];                                                              \
+            a[0] = a[end];                                                             \
+            a[end] = top;                                                              \
+            name##_sift(a, 0, end);                                                    \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static size_t name##_median3(const T *a, size_t i, size_t j, size_t k)             \
+    {                                                                                  \
+        if (LESS(a[i], a[j]))                                                          \
+            return LESS(a[j], a[k]) ? j : (LESS(a[i], a[k]) ? k : i);                  \
+        return LESS(a[i], a[k]) ? i : (LESS(a[j], a[k]) ? k : j);                      \
+    }                                                                                  \
+                                                                                       \
+    static void name##_intro(T *a, size_t n, int depth)                                \
+    {                                                                                  \
+        while (n > MML_SORT_INSERTION)                                                 \
+        {                                                                              \
+            if (depth-- == 0)                                                          \
+            {                                                                          \
+                name##_heapsort(a, n);                                                 \
+                return;                                                                \
+            }                                                                          \
+            size_t mid = n / 2, last = n - 1;                                          \
+            size_t p = name##_median3(a, 0, mid, last);                                \
+            if (n > 128)                                                               \
+            {                                                                          \
+                /* Tukey's ninther: the median of three medians. */                    \
+                size_t s = n / 8;                                                      \
+                size_t lo = name##_median3(a, 0, s, 2 * s);                            \
+                size_t md = name##_median3(a, mid - s, mid, mid + s);                  \
+                size_t hi = name##_median3(a, last - 2 * s, last - s, last);           \
+                p = name##_median3(a, lo, md, hi);                                     \
+            }                                                                          \
+            T pivot = a[p];                                                            \
+            a[p] = a[0];                                                               \
+            a[0] = pivot;                                                              \
+            /* a[0] holds the pivot, so the downward scan cannot run off the front. */ \
+            size_t i = 0, j = n;                                                       \
+            for (;;)                                                                   \
+            {                                                                          \
+                do                                                                     \
+                    i++;                                                               \
+                while (i < n && LESS(a[i], pivot));                                    \
+                do                                                                     \
+                    j--;                                                               \
+                while (LESS(pivot, a[j]));                                             \
+                if (i >= j)                                                            \
+                    break;                                                             \
+                T t = a[i];                                                            \
+                a[i] = a[j];                                                           \
+                a[j] = t;                                                              \
+            }                                                                          \
+            a[0] = a[j];                                                               \
+            a[j] = pivot;                                                              \
+            /* Recurse into the smaller side so the stack stays logarithmic. */        \
+            if (j < n - j - 1)                                                         \
+            {                                                                          \
+                name##_intro(a, j, depth);                                             \
+                a += j + 1;                                                            \
+                n -= j + 1;                                                            \
+            }                                                                          \
+            else                                                                       \
+            {                                                                          \
+                name##_intro(a + j + 1, n - j - 1, depth);                             \
+                n = j;                                                                 \
+            }                                                                          \
+        }                                                                              \
+        name##_insertion(a, n);                                                        \
+    }                                                                                  \
+                                                                                       \
+    static void name(T *a, size_t n)                                                   \
+    {                                                                                  \
+        int depth = 0;                                                                 \
+        for (size_t m = n; m > 1; m >>= 1)                                             \
+            depth += 2;                                                                \
+        name##_intro(a, n, depth);                                                     \
+    }
+
+// LSD radix sort of keys into ascending unsigned order, using tmp (same length) as the
+// other buffer. With signed_top the top byte is ordered as two's complement, so int64
+// keys sort without being transformed first.
+#define MML_DEFINE_RADIX(name, U)                                                      \
+    static void name(U *keys, U *tmp, size_t n, int signed_top)                        \
+    {                                                                                  \
+        enum { passes = sizeof(U) };                                                   \
+        size_t counts[passes][256];                                                    \
+        memset(counts, 0, sizeof(counts));                                             \
+        for (size_t i = 0; i < n; i++)                                                 \
+        {                                                                              \
+            U k = keys[i];                                                             \
+            for (int b = 0; b < passes; b++)                                           \
+                counts[b][(k >> (8 * b)) & 0xFF]++;                                    \
+        }                                                                              \
+        U *src = keys, *dst = tmp;                                                     \
+        for (int b = 0; b < passes; b++)                                               \
+        {                                                                              \
+            size_t *count = counts[b];                                                 \
+            int shift = 8 * b;                                                         \
+            if (count[(src[0] >> shift) & 0xFF] == n)                                  \
+                continue;                                                              \
+            int first = signed_top && b == passes - 1 ? 0x80 : 0;                      \
+            size_t sum = 0;                                                            \
+            for (int d = 0; d < 256; d++)                                              \
+            {                                                                          \
+                size_t c = count[(d + first) & 0xFF];                                  \
+                count[(d + first) & 0xFF] = sum;                                       \
+                sum += c;                                                              \
+            }                                                                          \
+            for (size_t i = 0; i < n; i++)                                             \
+            {                                                                          \
+                U k = src[i];                                                          \
+                dst[count[(k >> shift) & 0xFF]++] = k;                                 \
+            }                                                                          \
+            U *t = src;                                                                \
+            src = dst;                                                                 \
+            dst = t;                                                                   \
+        }                                                                              \
+        if (src != keys)                                                               \
+            memcpy(keys, src, n * sizeof(U));                                          \
+    }
+
+#define MML_LESS(a, b) ((a) < (b))
+#define MML_STR_LESS(a, b) (mml_str_cmp(&(a), &(b)) < 0)
+
+// Byte-wise comparison, shorter string first on a common prefix.
+static inline int mml_str_cmp(const String *a, const String *b)
+{
+    size_t la = mml_str_len(a), lb = mml_str_len(b);
+    int c = memcmp(mml_str_ptr(a), mml_str_ptr(b), la < lb ? la : lb);
+    return c != 0 ? c : (la > lb) - (la < lb);
+}
+
+MML_DEFINE_SORT(mml_sort_i64, int64_t, MML_LESS)
+MML_DEFINE_SORT(mml_sort_u32, uint32_t, MML_LESS)
+MML_DEFINE_SORT(mml_sort_str, String, MML_STR_LESS)
+MML_DEFINE_RADIX(mml_radix_u64, uint64_t)
+MML_DEFINE_RADIX(mml_radix_u32, uint32_t)
+
+// Sort n int64 keys in place, with scratch as the radix buffer when it is non-null.
+static void mml_sort_i64_with(int64_t *keys, int64_t *scratch, size_t n)
+{
+    if (n < MML_RADIX_MIN || !scratch)
+        mml_sort_i64(keys, n);
+    else
+        mml_radix_u64((uint64_t *)keys, (uint64_t *)scratch, n, 1);
+}
+
+// Map float bits to unsigned keys in IEEE total order: negatives are inverted, positives
+// get the sign bit set. -0.0 lands just before 0.0 and NaNs at the end matching their sign.
+static inline uint32_t mml_float_key(uint32_t bits)
+{
+    return bits ^ ((uint32_t)-(int32_t)(bits >> 31) | 0x80000000u);
+}
+
+static inline uint32_t mml_float_unkey(uint32_t key)
+{
+    return key ^ (((key >> 31) - 1) | 0x80000000u);
+}
+
+void ar_int_sort(IntArray arr)
+{
+    if (arr.length < 2)
+        return;
+    size_t n = (size_t)arr.length;
+    int64_t *scratch = n < MML_RADIX_MIN ? NULL : (int64_t *)malloc(n * sizeof(int64_t));
+    // Without scratch memory the introsort still sorts in place.
+    mml_sort_i64_with(arr.data, scratch, n);
+    free(scratch);
+}
+
+// Ascending in IEEE 754 total order, so NaNs do not break the sort.
+void ar_float_sort(FloatArray arr)
+{
+    if (arr.length < 2)
+        return;
+    size_t n = (size_t)arr.length;
+    uint32_t *keys = (uint32_t *)arr.data;
+    for (size_t i = 0; i < n; i++)
+        keys[i] = mml_float_key(keys[i]);
+    uint32_t *scratch = n < MML_RADIX_MIN ? NULL : (uint32_t *)malloc(n * sizeof(uint32_t));
+    if (scratch)
+        mml_radix_u32(keys, scratch, n, 0);
+    else
+        mml_sort_u32(keys, n);
+    free(scratch);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = mml_float_unkey(keys[i]);
+}
+
+// Byte-wise (UTF-8 code point) order. Only the String headers move.
+void ar_str_sort(StringArray arr)
+{
+    if (arr.length > 1)
+        mml_sort_str(arr.data, (size_t)arr.length);
 }
 
-// --- String to Integer Conversion (strict) ---
-int64_t str_to_int(String s)
+// Index of the first element not less than value in a sorted array, or its length.
+int64_t ar_int_lower_bound(IntArray arr, int64_t value)
 {
-    if (!s.data || s.length == 0)
-        return 0;
-
-    size_t i = 0;
-    int sign = 1;
-    if (s.data[0] == '-' || s.data[0] == '+')
-    {
-        sign = (s.data[0] == '-') ? -1 : 1;
-        i = 1;
-    }
-
-    if (i >= s.length)
+    if (arr.length <= 0)
         return 0;
-
-    int64_t value = 0;
-    for (; i < s.length; i++)
+    // Branchless: the loop always runs log2(n) steps and compiles to a conditional move.
+    const int64_t *first = arr.data;
+    for (size_t len = (size_t)arr.length; len > 1;)
     {
-        char c = s.data[i];
-        if (c < '0' || c > '9')
-            return 0;
-        value = (value * 10) + (c - '0');
+        size_t half = len / 2;
+        first += first[half - 1] < value ? half : 0;
+        len -= half;
     }
+    return (int64_t)(first - arr.data) + (*first < value);
+}
 
-    return value * sign;
+// Index of the first element equal to value in a sorted array, or -1.
+int64_t ar_int_binary_search(IntArray arr, int64_t value)
+{
+    int64_t idx = ar_int_lower_bound(arr, value);
+    return idx < arr.length && arr.data[idx] == value ? idx : -1;
 }
 
-// --- File Handling ---
+// --- Work-Stealing Task Pool ---
+// A fixed set of worker threads, each owning a Chase-Lev deque (Le et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models", PPoPP 2013). A worker pushes and pops
+// at the bottom of its own deque; idle workers steal from the top of a random victim's.
+// The thread that starts the pool becomes worker 0, so it runs tasks while it joins.
+//
+// The pool starts on first use with MML_THREADS workers (default: online CPUs). It
+// serves the parallel kernels below; mml_par_for, mml_spawn and mml_join have no prelude
+// bindings, since MML has no function values to pass them. Task bodies run on arbitrary
+// workers. They may allocate from the heap and the per-thread string pool, but their
+// region arena is not the caller's, so they must not free values allocated in a region.
+
+#define MML_POOL_MAX_WORKERS 256
+#define MML_DEQUE_CAPACITY 4096 // power of two; a full deque runs the task inline
+#define MML_IDLE_SPINS 2048
+
+typedef struct MmlTask
+{
+    void (*fn)(void *env);
+    void *env;
+    atomic_int done;
+    int heap; // allocated by mml_spawn, freed by mml_join
+} MmlTask;
 
-// Helper: convert MML String to null-terminated C string
-static char *to_cstr(String s)
+typedef struct
 {
-    char *cstr = (char *)malloc(s.length + 1);
-    if (!cstr)
-        mml_sys_oom_abort();
-    memcpy(cstr, s.data, s.length);
-    cstr[s.length] = '\0';
-    return cstr;
-}
+    _Alignas(64) atomic_llong top;
+    _Alignas(64) atomic_llong bottom;
+    _Alignas(64) _Atomic(MmlTask *) slots[MML_DEQUE_CAPACITY];
+} MmlDeque;
 
-int open_file(const char *path, const char *mode)
+typedef struct
 {
-    int flags = (!strcmp(mode, "r")) ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
-    return open(path, flags, 0644);
+    MmlDeque *deques;
+    int workers;
+    atomic_llong pending; // tasks sitting in some deque
+    atomic_int sleepers;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} MmlPool;
+
+static MmlPool mml_pool;
+static pthread_once_t mml_pool_once = PTHREAD_ONCE_INIT;
+static _Thread_local int mml_worker_id = -1;
+static _Thread_local uint32_t mml_steal_seed;
+
+static int mml_deque_push(MmlDeque *dq, MmlTask *task)
+{
+    long long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    if (b - t >= MML_DEQUE_CAPACITY)
+        return 0;
+    atomic_store_explicit(&dq->slots[b & (MML_DEQUE_CAPACITY - 1)], task, memory_order_relaxed);
+    // Release store rather than the paper's fence + relaxed store: the same ordering,
+    // and ThreadSanitizer understands it.
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_release);
+    return 1;
 }
 
-int open_file_read(String path)
+static MmlTask *mml_deque_pop(MmlDeque *dq)
 {
-    char *cpath = to_cstr(path);
-    if (!cpath)
-        return -1;
-    int fd = open(cpath, O_RDONLY, 0);
-    free(cpath);
-    return fd;
+    long long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+    if (t > b)
+    {
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    MmlTask *task =
+        atomic_load_explicit(&dq->slots[b & (MML_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (t == b)
+    {
+        // Last element: race the thieves for it.
+        if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed))
+            task = NULL;
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
 }
 
-int open_file_write(String path)
+static MmlTask *mml_deque_steal(MmlDeque *dq)
 {
-    char *cpath = to_cstr(path);
-    if (!cpath)
-        return -1;
-    int fd = open(cpath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    free(cpath);
-    return fd;
+    long long t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+    if (t >= b)
+        return NULL;
+    MmlTask *task =
+        atomic_load_explicit(&dq->slots[t & (MML_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return NULL;
+    return task;
 }
 
-int open_file_append(String path)
+// Output a task printed is written before the task counts as done, so it lands before
+// anything its joiner prints afterwards.
+static void mml_task_run(MmlTask *task)
 {
-    char *cpath = to_cstr(path);
-    if (!cpath)
-        return -1;
-    int fd = open(cpath, O_WRONLY | O_CREAT | O_APPEND, 0644);
-    free(cpath);
-    return fd;
+    atomic_fetch_sub_explicit(&mml_pool.pending, 1, memory_order_relaxed);
+    task->fn(task->env);
+    mml_sys_flush();
+    atomic_store_explicit(&task->done, 1, memory_order_release);
 }
 
-ssize_t read_file(int fd, char *buffer, size_t size)
+// Own deque first, then one pass over the others starting at a random victim.
+static MmlTask *mml_pool_find_task(int self)
 {
-    return read(fd, buffer, size);
+    MmlTask *task = mml_deque_pop(&mml_pool.deques[self]);
+    if (task)
+        return task;
+    int n = mml_pool.workers;
+    mml_steal_seed ^= mml_steal_seed << 13;
+    mml_steal_seed ^= mml_steal_seed >> 17;
+    mml_steal_seed ^= mml_steal_seed << 5;
+    int start = (int)(mml_steal_seed % (uint32_t)n);
+    for (int i = 0; i < n; i++)
+    {
+        int victim = (start + i) % n;
+        if (victim != self && (task = mml_deque_steal(&mml_pool.deques[victim])))
+            return task;
+    }
+    return NULL;
 }
 
-ssize_t write_file(int fd, const char *buffer, size_t size)
+static inline void mml_cpu_relax(void)
 {
-    return write(fd, buffer, size);
+#if defined(__x86_64__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
 }
 
-void close_file(int fd)
+static void *mml_worker_main(void *arg)
 {
-    close(fd);
+    mml_worker_id = (int)(intptr_t)arg;
+    mml_steal_seed = 2654435761u * (uint32_t)(mml_worker_id + 1);
+    for (;;)
+    {
+        MmlTask *task = NULL;
+        for (int spin = 0; spin < MML_IDLE_SPINS && !task; spin++)
+        {
+            task = mml_pool_find_task(mml_worker_id);
+            if (!task)
+                mml_cpu_relax();
+        }
+        if (task)
+        {
+            mml_task_run(task);
+            continue;
+        }
+        // Sleep until a push. sleepers and pending are both seq_cst, so either the
+        // pusher sees this worker as a sleeper or this worker sees the pending task.
+        pthread_mutex_lock(&mml_pool.lock);
+        atomic_fetch_add(&mml_pool.sleepers, 1);
+        while (atomic_load(&mml_pool.pending) == 0)
+            pthread_cond_wait(&mml_pool.wake, &mml_pool.lock);
+        atomic_fetch_sub(&mml_pool.sleepers, 1);
+        pthread_mutex_unlock(&mml_pool.lock);
+    }
+    return NULL;
 }
 
-String read_line_fd(int fd)
+static void mml_pool_start(void)
 {
-    if (fd == STDIN_FILENO)
-        mml_sys_flush();
-    size_t size = 1024;
-    size_t len = 0;
-    char *buffer = (char *)malloc(size);
-    if (!buffer)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cpus > 0 ? (int)cpus : 1;
+    const char *env = getenv("MML_THREADS");
+    if (env && *env)
+        workers = atoi(env);
+    if (workers < 1)
+        workers = 1;
+    if (workers > MML_POOL_MAX_WORKERS)
+        workers = MML_POOL_MAX_WORKERS;
+
+    MmlDeque *deques = NULL;
+    if (posix_memalign((void **)&deques, 64, (size_t)workers * sizeof(MmlDeque)) != 0)
         mml_sys_oom_abort();
-
-    char c;
-    while (read(fd, &c, 1) == 1 && c != '\n')
+    memset(deques, 0, (size_t)workers * sizeof(MmlDeque));
+    mml_pool.deques = deques;
+    mml_pool.workers = workers;
+    pthread_mutex_init(&mml_pool.lock, NULL);
+    pthread_cond_init(&mml_pool.wake, NULL);
+
+    mml_worker_id = 0;
+    mml_steal_seed = 2654435761u;
+    for (int i = 1; i < workers; i++)
     {
-        if (len + 1 >= size)
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, mml_worker_main, (void *)(intptr_t)i) != 0)
         {
-            size *= 2;
-            char *new_buf = (char *)realloc(buffer, size);
-            if (!new_buf)
-                mml_sys_oom_abort();
-            buffer = new_buf;
+            // Run with the workers we got; their deques stay empty.
+            mml_pool.workers = i;
+            break;
         }
-        buffer[len++] = c;
+        pthread_detach(thread);
     }
-    buffer[len] = '\0';
-    return (String){len, buffer};
 }
 
-// --- Process Execution ---
-int run_process(const char *cmd, char *const argv[])
+static inline void mml_pool_ensure(void)
+{
+    pthread_once(&mml_pool_once, mml_pool_start);
+}
+
+// Queue task on the calling worker's deque. Threads outside the pool, and a full deque,
+// run it on the spot instead.
+static void mml_task_submit(MmlTask *task)
 {
-    pid_t pid = fork();
-    if (pid == 0)
+    mml_pool_ensure();
+    atomic_store_explicit(&task->done, 0, memory_order_relaxed);
+    if (mml_pool.workers > 1 && mml_worker_id >= 0)
     {
-        execvp(cmd, argv);
-        exit(1);
+        // Output printed before the fork goes out before anything the task prints.
+        mml_sys_flush();
+        atomic_fetch_add(&mml_pool.pending, 1);
+        if (mml_deque_push(&mml_pool.deques[mml_worker_id], task))
+        {
+            if (atomic_load(&mml_pool.sleepers) > 0)
+            {
+                pthread_mutex_lock(&mml_pool.lock);
+                pthread_cond_signal(&mml_pool.wake);
+                pthread_mutex_unlock(&mml_pool.lock);
+            }
+            return;
+        }
+        atomic_fetch_sub(&mml_pool.pending, 1);
     }
-    int status;
-    waitpid(pid, &status, 0);
-    return WEXITSTATUS(status);
+    task->fn(task->env);
+    atomic_store_explicit(&task->done, 1, memory_order_release);
 }
 
-int run_process_with_output(const char *cmd, char *const argv[], char *output, size_t size)
+// Wait for task, running other tasks meanwhile. The task is usually still at the bottom
+// of this worker's deque, so the first pop picks it straight back up.
+static void mml_task_wait(MmlTask *task)
 {
-    int pipefd[2];
-    if (pipe(pipefd) == -1)
-        return -1;
-
-    pid_t pid = fork();
-    if (pid == 0)
+    while (!atomic_load_explicit(&task->done, memory_order_acquire))
     {
-        close(pipefd[0]);
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[1]);
-        execvp(cmd, argv);
-        exit(1);
+        MmlTask *other = mml_worker_id >= 0 ? mml_pool_find_task(mml_worker_id) : NULL;
+        if (other)
+            mml_task_run(other);
+        else
+            mml_cpu_relax();
     }
-    close(pipefd[1]);
-    ssize_t bytes = read(pipefd[0], output, size - 1);
-    close(pipefd[0]);
-    if (bytes > 0)
-        output[bytes] = '\0';
-    int status;
-    waitpid(pid, &status, 0);
-    return WEXITSTATUS(status);
 }
 
-// --- IntArray Functions ---
-FORCE_INLINE IntArray ar_int_new(int64_t size)
+int64_t par_workers(void)
 {
-    if (size <= 0)
-        return (IntArray){0, NULL};
+    mml_pool_ensure();
+    return mml_pool.workers;
+}
 
-    int64_t *storage = (int64_t *)malloc((size_t)size * sizeof(int64_t));
-    if (!storage)
+MmlTask *mml_spawn(void (*fn)(void *env), void *env)
+{
+    MmlTask *task = (MmlTask *)malloc(sizeof(MmlTask));
+    if (!task)
         mml_sys_oom_abort();
+    task->fn = fn;
+    task->env = env;
+    task->heap = 1;
+    mml_task_submit(task);
+    return task;
+}
 
-    return (IntArray){size, storage};
+void mml_join(MmlTask *task)
+{
+    mml_task_wait(task);
+    if (task->heap)
+        free(task);
 }
 
-FORCE_INLINE void ar_int_set(IntArray arr, int64_t idx, int64_t value)
+typedef struct
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    int64_t lo;
+    int64_t hi;
+    int64_t grain;
+    void (*fn)(int64_t lo, int64_t hi, void *env);
+    void *env;
+} MmlParRange;
+
+static void mml_par_range(void *arg);
+
+// Split [lo, hi) in halves until a piece is at most grain long. The upper half of each
+// split is left for thieves; the lower half runs here.
+static void mml_par_split(MmlParRange range)
+{
+    if (range.hi - range.lo <= range.grain)
     {
-        fprintf(stderr, "IntArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        range.fn(range.lo, range.hi, range.env);
+        return;
     }
-    arr.data[idx] = value;
+    MmlParRange upper = range;
+    upper.lo = range.lo + (range.hi - range.lo) / 2;
+    MmlTask task = {.fn = mml_par_range, .env = &upper, .heap = 0};
+    mml_task_submit(&task);
+    range.hi = upper.lo;
+    mml_par_split(range);
+    mml_task_wait(&task);
 }
 
-FORCE_INLINE void unsafe_ar_int_set(IntArray arr, int64_t idx, int64_t value)
-{    
-    arr.data[idx] = value;
+static void mml_par_range(void *arg)
+{
+    mml_par_split(*(MmlParRange *)arg);
 }
 
-FORCE_INLINE int64_t ar_int_get(IntArray arr, int64_t idx)
+// Call fn on disjoint pieces of [lo, hi) covering the whole range, possibly in parallel,
+// and return once all have finished. grain <= 0 picks about eight pieces per worker.
+void mml_par_for(int64_t lo, int64_t hi, int64_t grain,
+                 void (*fn)(int64_t lo, int64_t hi, void *env), void *env)
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    if (hi <= lo)
+        return;
+    mml_pool_ensure();
+    if (grain <= 0)
+        grain = (hi - lo) / ((int64_t)mml_pool.workers * 8);
+    if (grain < 1)
+        grain = 1;
+    if (mml_pool.workers == 1 || mml_worker_id < 0 || hi - lo <= grain)
     {
-        
-        fprintf(stderr, "IntArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        fn(lo, hi, env);
+        return;
     }
-    return arr.data[idx];
+    mml_par_split((MmlParRange){lo, hi, grain, fn, env});
 }
 
-FORCE_INLINE int64_t unsafe_ar_int_get(IntArray arr, int64_t idx)
-{    
-    return arr.data[idx];
-}
+// --- Parallel Array Kernels ---
+// Row-parallel n x n matrix multiply, c = a * b, over arrays laid out row-major. Each
+// row of c is written by one task in i-k-j order, so the inner loop is a contiguous
+// multiply-add the vectorizer handles, and the result does not depend on the split.
 
-FORCE_INLINE int64_t ar_int_len(IntArray arr)
+typedef struct
 {
-    return arr.length;
-}
+    const void *a;
+    const void *b;
+    void *c;
+    int64_t n;
+} MmlMatmulEnv;
 
-// --- StringArray Functions ---
-FORCE_INLINE StringArray ar_str_new(int64_t size)
+static void mml_check_square(const char *kind, int64_t n, int64_t a, int64_t b, int64_t c)
 {
-    if (size <= 0)
-        return (StringArray){0, NULL};
-
-    String *storage = (String *)malloc((size_t)size * sizeof(String));
-    if (!storage)
-        mml_sys_oom_abort();
-
-    return (StringArray){size, storage};
+    int64_t size = n < 0 || (n > 0 && n > INT64_MAX / n) ? -1 : n * n;
+    if (MML_UNLIKELY(size < 0 || a < size))
+        mml_range_trap(kind, 0, size, a);
+    if (MML_UNLIKELY(b < size))
+        mml_range_trap(kind, 0, size, b);
+    if (MML_UNLIKELY(c < size))
+        mml_range_trap(kind, 0, size, c);
 }
 
-FORCE_INLINE void ar_str_set(StringArray arr, int64_t idx, String value)
+static void mml_matmul_rows_i64(int64_t lo, int64_t hi, void *arg)
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    const MmlMatmulEnv *env = (const MmlMatmulEnv *)arg;
+    const int64_t *a = (const int64_t *)env->a, *b = (const int64_t *)env->b;
+    int64_t *c = (int64_t *)env->c;
+    int64_t n = env->n;
+    for (int64_t i = lo; i < hi; i++)
     {
-        
-        fprintf(stderr, "StringArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        int64_t *restrict row = c + i * n;
+        memset(row, 0, (size_t)n * sizeof(int64_t));
+        for (int64_t k = 0; k < n; k++)
+        {
+            // Wrapping multiply-add, like Int arithmetic.
+            uint64_t aik = (uint64_t)a[i * n + k];
+            const int64_t *restrict brow = b + k * n;
+            for (int64_t j = 0; j < n; j++)
+                row[j] = (int64_t)((uint64_t)row[j] + aik * (uint64_t)brow[j]);
+        }
     }
-    arr.data[idx] = value;
 }
 
-FORCE_INLINE String ar_str_get(StringArray arr, int64_t idx)
+static void mml_matmul_rows_f32(int64_t lo, int64_t hi, void *arg)
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    const MmlMatmulEnv *env = (const MmlMatmulEnv *)arg;
+    const float *a = (const float *)env->a, *b = (const float *)env->b;
+    float *c = (float *)env->c;
+    int64_t n = env->n;
+    for (int64_t i = lo; i < hi; i++)
     {
-        
-        fprintf(stderr, "StringArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        float *restrict row = c + i * n;
+        for (int64_t j = 0; j < n; j++)
+            row[j] = 0.0f;
+        for (int64_t k = 0; k < n; k++)
+        {
+            float aik = a[i * n + k];
+            const float *restrict brow = b + k * n;
+            for (int64_t j = 0; j < n; j++)
+                row[j] += aik * brow[j];
+        }
     }
-    return arr.data[idx];
 }
 
-FORCE_INLINE int64_t ar_str_len(StringArray arr)
+// c = a * b for n x n matrices. c must not alias a or b.
+void ar_int_matmul(IntArray a, IntArray b, IntArray c, int64_t n)
 {
-    return arr.length;
+    mml_check_square("IntArray", n, a.length, b.length, c.length);
+    if (n == 0)
+        return;
+    MmlMatmulEnv env = {a.data, b.data, c.data, n};
+    mml_par_for(0, n, 0, mml_matmul_rows_i64, &env);
 }
 
-// --- FloatArray Functions ---
-FORCE_INLINE FloatArray ar_float_new(int64_t size)
+void ar_float_matmul(FloatArray a, FloatArray b, FloatArray c, int64_t n)
 {
-    if (size <= 0)
-        return (FloatArray){0, NULL};
+    mml_check_square("FloatArray", n, a.length, b.length, c.length);
+    if (n == 0)
+        return;
+    MmlMatmulEnv env = {a.data, b.data, c.data, n};
+    mml_par_for(0, n, 0, mml_matmul_rows_f32, &env);
+}
 
-    float *storage = (float *)malloc((size_t)size * sizeof(float));
-    if (!storage)
-        mml_sys_oom_abort();
+// Parallel int sort: one most-significant-digit pass spreads the keys over 256 buckets
+// by value range, then the buckets are radix sorted independently. Every phase is a
+// par_for over fixed chunks, so the result is the same as ar_int_sort's.
+
+#define MML_PAR_SORT_MIN (1 << 16)
+#define MML_PAR_SORT_CHUNKS 256
+
+typedef struct
+{
+    int64_t *keys;
+    int64_t *tmp;
+    size_t n;
+    int64_t chunks;
+    uint64_t low;
+    int shift;
+    uint64_t *bounds;      // [chunks][2]: min and max key per chunk, sign-flipped
+    size_t (*counts)[256]; // [chunks][256]: bucket counts, then scatter offsets
+    size_t *starts;        // [257]: bucket boundaries
+} MmlParSortEnv;
+
+#define MML_SORT_FLIP(k) ((uint64_t)(k) ^ 0x8000000000000000ull)
+
+static inline size_t mml_par_sort_lo(const MmlParSortEnv *env, int64_t chunk)
+{
+    // floor(n * chunk / chunks) without the overflowing product.
+    size_t chunks = (size_t)env->chunks, c = (size_t)chunk;
+    return env->n / chunks * c + env->n % chunks * c / chunks;
+}
 
-    return (FloatArray){size, storage};
+static inline size_t mml_par_sort_bucket(const MmlParSortEnv *env, int64_t key)
+{
+    return (size_t)((MML_SORT_FLIP(key) - env->low) >> env->shift);
 }
 
-FORCE_INLINE void ar_float_set(FloatArray arr, int64_t idx, float value)
+static void mml_par_sort_bounds(int64_t lo, int64_t hi, void *arg)
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    MmlParSortEnv *env = (MmlParSortEnv *)arg;
+    for (int64_t c = lo; c < hi; c++)
     {
-        fprintf(stderr, "FloatArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        uint64_t mn = UINT64_MAX, mx = 0;
+        for (size_t i = mml_par_sort_lo(env, c), end = mml_par_sort_lo(env, c + 1); i < end; i++)
+        {
+            uint64_t k = MML_SORT_FLIP(env->keys[i]);
+            mn = k < mn ? k : mn;
+            mx = k > mx ? k : mx;
+        }
+        env->bounds[2 * c] = mn;
+        env->bounds[2 * c + 1] = mx;
     }
-    arr.data[idx] = value;
 }
 
-FORCE_INLINE void unsafe_ar_float_set(FloatArray arr, int64_t idx, float value)
-{    
-    arr.data[idx] = value;
+static void mml_par_sort_count(int64_t lo, int64_t hi, void *arg)
+{
+    MmlParSortEnv *env = (MmlParSortEnv *)arg;
+    for (int64_t c = lo; c < hi; c++)
+    {
+        size_t *count = env->counts[c];
+        memset(count, 0, 256 * sizeof(size_t));
+        for (size_t i = mml_par_sort_lo(env, c), end = mml_par_sort_lo(env, c + 1); i < end; i++)
+            count[mml_par_sort_bucket(env, env->keys[i])]++;
+    }
 }
 
-FORCE_INLINE float ar_float_get(FloatArray arr, int64_t idx)
+static void mml_par_sort_scatter(int64_t lo, int64_t hi, void *arg)
 {
-    if (!arr.data || idx < 0 || idx >= arr.length)
+    MmlParSortEnv *env = (MmlParSortEnv *)arg;
+    for (int64_t c = lo; c < hi; c++)
     {
-        fprintf(stderr, "FloatArray index out of bounds: %lld (length: %lld)\n",
-                (long long)idx, (long long)arr.length);
-        fflush(stderr);
-        exit(1);
+        size_t *offset = env->counts[c];
+        for (size_t i = mml_par_sort_lo(env, c), end = mml_par_sort_lo(env, c + 1); i < end; i++)
+        {
+            int64_t k = env->keys[i];
+            env->tmp[offset[mml_par_sort_bucket(env, k)]++] = k;
+        }
     }
-    return arr.data[idx];
 }
 
-FORCE_INLINE float unsafe_ar_float_get(FloatArray arr, int64_t idx)
-{    
-    return arr.data[idx];
+// Each bucket moves back into keys and is sorted there, with its slice of tmp as scratch.
+static void mml_par_sort_buckets(int64_t lo, int64_t hi, void *arg)
+{
+    MmlParSortEnv *env = (MmlParSortEnv *)arg;
+    for (int64_t d = lo; d < hi; d++)
+    {
+        size_t start = env->starts[d], len = env->starts[d + 1] - start;
+        memcpy(env->keys + start, env->tmp + start, len * sizeof(int64_t));
+        mml_sort_i64_with(env->keys + start, env->tmp + start, len);
+    }
 }
 
-FORCE_INLINE int64_t ar_float_len(FloatArray arr)
+// Same result as ar_int_sort, spread over the task pool for large arrays.
+void ar_int_par_sort(IntArray arr)
 {
-    return arr.length;
+    size_t n = arr.length > 0 ? (size_t)arr.length : 0;
+    if (n < MML_PAR_SORT_MIN || par_workers() == 1 || mml_worker_id < 0)
+    {
+        ar_int_sort(arr);
+        return;
+    }
+    int64_t chunks = MML_PAR_SORT_CHUNKS;
+    int64_t *tmp = (int64_t *)malloc(n * sizeof(int64_t));
+    uint64_t *bounds = (uint64_t *)malloc((size_t)chunks * 2 * sizeof(uint64_t));
+    size_t(*counts)[256] = malloc((size_t)chunks * sizeof(*counts));
+    if (!tmp || !bounds || !counts)
+    {
+        free(tmp);
+        free(bounds);
+        free(counts);
+        ar_int_sort(arr);
+        return;
+    }
+    size_t starts[257];
+    MmlParSortEnv env = {arr.data, tmp, n, chunks, 0, 0, bounds, counts, starts};
+
+    mml_par_for(0, chunks, 1, mml_par_sort_bounds, &env);
+    uint64_t low = UINT64_MAX, high = 0;
+    for (int64_t c = 0; c < chunks; c++)
+    {
+        low = bounds[2 * c] < low ? bounds[2 * c] : low;
+        high = bounds[2 * c + 1] > high ? bounds[2 * c + 1] : high;
+    }
+    // Pick the shift that maps the whole key range onto the 256 buckets.
+    int shift = 0;
+    while (((high - low) >> shift) > 255)
+        shift++;
+    env.low = low;
+    env.shift = shift;
+
+    mml_par_for(0, chunks, 1, mml_par_sort_count, &env);
+    // Turn the counts into scatter offsets: bucket by bucket, chunk by chunk.
+    size_t sum = 0;
+    for (int d = 0; d < 256; d++)
+    {
+        starts[d] = sum;
+        for (int64_t c = 0; c < chunks; c++)
+        {
+            size_t count = counts[c][d];
+            counts[c][d] = sum;
+            sum += count;
+        }
+    }
+    starts[256] = sum;
+
+    mml_par_for(0, chunks, 1, mml_par_sort_scatter, &env);
+    mml_par_for(0, 256, 1, mml_par_sort_buckets, &env);
+
+    free(tmp);
+    free(bounds);
+    free(counts);
 }
 
 void __mml_sys_hole(int64_t start_line, int64_t start_col, int64_t end_line, int64_t end_col)
@@ -850,58 +4534,109 @@ void __mml_sys_hole(int64_t start_line, int64_t start_col, int64_t end_line, int
 
 void __free_String(String s)
 {
-    if (s.data)
-        free(s.data);
+    MML_STAT_FREE(String);
+    if (!mml_str_is_inline(&s))
+        mml_str_release(s.data, s.length + 1);
 }
 
 void __free_Buffer(Buffer b)
 {
+    MML_STAT_FREE(Buffer);
     if (b)
+        mml_buffer_release(b);
+}
+
+void __free_Reader(Reader r)
+{
+    MML_STAT_FREE(Reader);
+    if (r)
     {
-        if (b->data)
-            free(b->data);
-        free(b);
+        free(r->data);
+        free(r->line);
+        free(r);
     }
 }
 
-void __free_IntArray(IntArray arr)
+void __free_MappedFile(MappedFile m)
 {
-    if (arr.data)
-        free(arr.data);
+    MML_STAT_FREE(MappedFile);
+    if (m)
+    {
+        if (m->addr)
+            munmap(m->addr, m->len);
+        free(m);
+    }
 }
 
-void __free_StringArray(StringArray arr)
+// Flushes still in flight finish with blocking writes before the loop goes away.
+void __free_EventLoop(EventLoop loop)
 {
-    if (arr.data)
+    MML_STAT_FREE(EventLoop);
+    if (!loop)
+        return;
+    for (int fd = 0; fd < loop->watch_cap; fd++)
     {
-        for (int64_t i = 0; i < arr.length; i++)
+        Buffer b = loop->watches[fd].flush;
+        if (b)
         {
-            __free_String(arr.data[i]);
+            b->ev_loop = NULL;
+            flush(b);
         }
-        free(arr.data);
     }
+    if (loop->backend >= 0)
+        close(loop->backend);
+    free(loop->watches);
+    free(loop->ready);
+#if defined(MML_EV_KQUEUE)
+    free(loop->changes);
+#endif
+    free(loop);
+}
+
+void __free_IntMap(IntMap m)
+{
+    MML_STAT_FREE(IntMap);
+    if (m)
+        mml_table_release(m);
+}
+
+void __free_StringMap(StringMap m)
+{
+    MML_STAT_FREE(StringMap);
+    if (m)
+        mml_table_release(m);
+}
+
+void __free_StringSet(StringSet s)
+{
+    MML_STAT_FREE(StringSet);
+    if (s)
+        mml_table_release(s);
 }
 
-void __free_FloatArray(FloatArray arr)
+// Scalar arrays get __free_/__clone_ from MML_DEFINE_ARRAY above.
+void __free_StringArray(StringArray arr)
 {
+    MML_STAT_FREE(StringArray);
     if (arr.data)
-        free(arr.data);
+    {
+        for (int64_t i = 0; i < arr.length; i++)
+        {
+            __free_String(arr.data[i]);
+        }
+        mml_free(arr.data);
+    }
 }
 
 // --- Memory Management Clone Functions ---
 
 String __clone_String(String s)
 {
-    if (!s.data || s.length == 0)
-        return (String){0, NULL};
-
-    char *new_data = (char *)malloc(s.length + 1);
-    if (!new_data)
-        mml_sys_oom_abort();
-
-    memcpy(new_data, s.data, s.length);
-    new_data[s.length] = '\0';
-    return (String){s.length, new_data};
+    MML_STAT_CLONE(String, mml_str_is_inline(&s) ? 0 : s.length);
+    // Inline strings carry their bytes with them: copying the struct is the clone.
+    if (mml_str_is_inline(&s))
+        return s;
+    return mml_str_from(s.data, s.length);
 }
 
 StringArray mml_args_to_array(int argc, char **argv)
@@ -921,44 +4656,95 @@ StringArray mml_args_to_array(int argc, char **argv)
 
 Buffer __clone_Buffer(Buffer b)
 {
+    MML_STAT_CLONE(Buffer, b ? b->length : 0);
     if (!b)
         return NULL;
 
-    Buffer new_b = (Buffer)malloc(sizeof(BufferImpl));
-    if (!new_b)
-        mml_sys_oom_abort();
-
-    new_b->capacity = b->capacity;
+    Buffer new_b = mml_buffer_new(b->capacity, b->fd);
     new_b->length = b->length;
-    new_b->fd = b->fd;
-    new_b->data = (char *)malloc(b->capacity);
-    if (!new_b->data)
-        mml_sys_oom_abort();
     memcpy(new_b->data, b->data, b->length);
     return new_b;
 }
 
-IntArray __clone_IntArray(IntArray arr)
+Reader __clone_Reader(Reader r)
 {
-    if (!arr.data || arr.length <= 0)
-        return (IntArray){0, NULL};
+    MML_STAT_CLONE(Reader, r ? r->end - r->start : 0);
+    if (!r)
+        return NULL;
+
+    Reader new_r = mkReader(r->fd);
+    new_r->eof = r->eof;
+    new_r->end = r->end - r->start;
+    memcpy(new_r->data, r->data + r->start, new_r->end);
+    return new_r;
+}
+
+// The copy is an anonymous mapping, so it is released by __free_MappedFile the same way.
+MappedFile __clone_MappedFile(MappedFile m)
+{
+    MML_STAT_CLONE(MappedFile, m ? m->len : 0);
+    if (!m)
+        return NULL;
 
-    int64_t *new_data = (int64_t *)malloc((size_t)arr.length * sizeof(int64_t));
-    if (!new_data)
+    MappedFile new_m = (MappedFile)malloc(sizeof(MappedFileImpl));
+    if (!new_m)
         mml_sys_oom_abort();
+    *new_m = *m;
+    if (m->addr)
+    {
+        void *p = mmap(NULL, m->len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            mml_sys_oom_abort();
+        memcpy(p, m->addr, m->len);
+        mprotect(p, m->len, PROT_READ);
+        new_m->addr = (char *)p;
+    }
+    return new_m;
+}
+
+// The copy watches the same fds with the same callbacks; pending flushes stay with the
+// original loop.
+EventLoop __clone_EventLoop(EventLoop loop)
+{
+    MML_STAT_CLONE(EventLoop, 0);
+    if (!loop)
+        return NULL;
+
+    EventLoop new_loop = ev_new();
+    for (int fd = 0; fd < loop->watch_cap; fd++)
+    {
+        MmlEvWatch *w = &loop->watches[fd];
+        if (w->events)
+            mml_ev_watch(new_loop, fd, w->events, w->cb, w->ctx);
+    }
+    return new_loop;
+}
+
+IntMap __clone_IntMap(IntMap m)
+{
+    MML_STAT_CLONE(IntMap, m ? mml_table_bytes(m) : 0);
+    return m ? mml_table_clone(m) : NULL;
+}
 
-    memcpy(new_data, arr.data, (size_t)arr.length * sizeof(int64_t));
-    return (IntArray){arr.length, new_data};
+StringMap __clone_StringMap(StringMap m)
+{
+    MML_STAT_CLONE(StringMap, m ? mml_table_bytes(m) : 0);
+    return m ? mml_table_clone(m) : NULL;
+}
+
+StringSet __clone_StringSet(StringSet s)
+{
+    MML_STAT_CLONE(StringSet, s ? mml_table_bytes(s) : 0);
+    return s ? mml_table_clone(s) : NULL;
 }
 
 StringArray __clone_StringArray(StringArray arr)
 {
+    MML_STAT_CLONE(StringArray, arr.length > 0 ? (size_t)arr.length * sizeof(String) : 0);
     if (!arr.data || arr.length <= 0)
         return (StringArray){0, NULL};
 
-    String *new_data = (String *)malloc((size_t)arr.length * sizeof(String));
-    if (!new_data)
-        mml_sys_oom_abort();
+    String *new_data = (String *)mml_alloc((size_t)arr.length * sizeof(String));
 
     for (int64_t i = 0; i < arr.length; i++)
     {
@@ -966,16 +4752,3 @@ StringArray __clone_StringArray(StringArray arr)
     }
     return (StringArray){arr.length, new_data};
 }
-
-FloatArray __clone_FloatArray(FloatArray arr)
-{
-    if (!arr.data || arr.length <= 0)
-        return (FloatArray){0, NULL};
-
-    float *new_data = (float *)malloc((size_t)arr.length * sizeof(float));
-    if (!new_data)
-        mml_sys_oom_abort();
-
-    memcpy(new_data, arr.data, (size_t)arr.length * sizeof(float));
-    return (FloatArray){arr.length, new_data};
-}
@@ -4,7 +4,14 @@ import cats.effect.{ExitCode, IO}
 import cats.syntax.all.*
 import mml.mmlclib.MmlLibBuildInfo
 import mml.mmlclib.codegen.LlvmToolchain
-import mml.mmlclib.compiler.{CodegenStage, CompilerConfig, CompilerState, Counter, FileOperations}
+import mml.mmlclib.compiler.{
+  CodegenStage,
+  CompilerConfig,
+  CompilerState,
+  Counter,
+  FileOperations,
+  ProfileReport
+}
 import mml.mmlclib.errors.CompilationError
 import mml.mmlclib.parser.{ParserError, SourceInfo}
 import mml.mmlclib.semantic.SemanticError
@@ -58,7 +65,7 @@ object CompilerApi:
         case Right(state) =>
           if state.hasErrors then
             IO.println(compilationFailed(prettyPrintStateErrors(state)))
-              *> maybePrintTimings(state).as(Left(ExitCode.Error))
+              *> reportMetrics(state).as(Left(ExitCode.Error))
           else IO.pure(Right(state))
     yield outcome
 
@@ -73,7 +80,7 @@ object CompilerApi:
         val validated = CodegenStage.validate(state)
         if validated.hasErrors then
           IO.println(compilationFailed(prettyPrintStateErrors(validated)))
-            *> maybePrintTimings(validated).as(Left(ExitCode.Error))
+            *> reportMetrics(validated).as(Left(ExitCode.Error))
         else IO.pure(Right(validated))
     }
 
@@ -225,7 +232,7 @@ object CompilerApi:
       case Right(state) =>
         FileOperations
           .writeAstToFile(state.module, config.outputDir.toString)
-          .flatMap(_ => maybePrintTimings(state).as(ExitCode.Success))
+          .flatMap(_ => reportMetrics(state).as(ExitCode.Success))
     }
 
   def processIrOnly(path: Path, config: CompilerConfig): IO[ExitCode] =
@@ -248,7 +255,7 @@ object CompilerApi:
                 )
               case None =>
                 IO.println(compilationFailed(prettyPrintStateErrors(finalState))).as(ExitCode.Error)
-            _ <- maybePrintTimings(finalState)
+            _ <- reportMetrics(finalState)
           yield exit
         }
     }
@@ -311,7 +318,7 @@ object CompilerApi:
         case None =>
           IO.println(compilationFailed(prettyPrintStateErrors(finalState)))
             .as(ExitCode.Error)
-      _ <- maybePrintTimings(finalState)
+      _ <- reportMetrics(finalState)
     yield exit
 
   private def processNativeRun(state: CompilerState): IO[ExitCode] =
@@ -321,7 +328,7 @@ object CompilerApi:
           FileOperations.writeAstToFile(state.module, state.config.outputDir.toString)
         else IO.unit
       finalState <- CodegenStage.processNative(state)
-      _ <- maybePrintTimings(finalState)
+      _ <- reportMetrics(finalState)
       exit <- finalState.nativeResult match
         case Some(_) => executeBinary(finalState)
         case None =>
@@ -366,6 +373,20 @@ object CompilerApi:
       }.flatMap(path => IO.println(s"LLVM IR written to $path").as(ExitCode.Success))
     else IO.unit.as(ExitCode.Success)
 
+  private def reportMetrics(state: CompilerState): IO[Unit] =
+    maybePrintTimings(state) *> maybeWriteProfile(state)
+
+  private def maybeWriteProfile(state: CompilerState): IO[Unit] =
+    state.config.profileOut match
+      case None => IO.unit
+      case Some(path) =>
+        ProfileReport
+          .write(path, state)
+          .flatMap(_ => IO.println(s"Profile written to $path"))
+          .handleErrorWith(error =>
+            IO.println(s"Failed to write profile to $path: ${error.getMessage}")
+          )
+
   private def maybePrintTimings(state: CompilerState): IO[Unit] =
     if !state.config.showTimings then IO.unit
     else if state.timings.isEmpty then IO.println("No timings recorded.")
@@ -401,7 +422,7 @@ object CompilerApi:
   private def printCounters(counters: Vector[Counter]): IO[Unit] =
     if counters.isEmpty then IO.unit
     else
-      val counterHeader = s"${Console.CYAN}Parser metrics:${Console.RESET}"
+      val counterHeader = s"${Console.CYAN}Metrics:${Console.RESET}"
       val counterLines = counters.map { c =>
         if c.name.startsWith("time:") then
           val ms = c.value.toDouble / 1000000.0
@@ -5,14 +5,16 @@ import cats.syntax.all.*
 import mml.mmlclib.compiler.CompilerConfig
 import mml.mmlclib.errors.CompilationError
 
-import java.io.{File, InputStream}
+import java.io.{ByteArrayInputStream, File, InputStream}
+import java.nio.charset.StandardCharsets
 import java.nio.file.{Files, Path, Paths, StandardCopyOption}
+import java.security.MessageDigest
 import scala.jdk.CollectionConverters.*
 import scala.sys.process.{Process, ProcessLogger}
 
 case class ToolInfo(versions: Map[String, String], missing: List[String])
 
-case class PipelineTiming(name: String, durationNanos: Long)
+case class PipelineTiming(name: String, durationNanos: Long, startNanos: Long = 0L)
 
 enum CompilationMode derives CanEqual:
   case Exe
@@ -56,6 +58,23 @@ object LlvmToolchain:
   private def clangAsanFlags(asan: Boolean): List[String] =
     if asan then List("-fsanitize=address", "-fno-omit-frame-pointer") else Nil
 
+  /** Compiles the runtime's MML_STATS counters in; see "Runtime Statistics" in mml_runtime.c. */
+  private def clangStatsFlags(runtimeStats: Boolean): List[String] =
+    if runtimeStats then List("-DMML_STATS") else Nil
+
+  /** The runtime's task pool uses POSIX threads. */
+  private val clangThreadFlags = List("-pthread")
+
+  /** The runtime's SIMD kernels are chosen from the CPU it is compiled for: x86 clang takes
+    * the CPU through `-march`, AArch64 through `-mcpu`.
+    */
+  private def runtimeCpuFlags(targetTriple: String, targetCpu: Option[String]): List[String] =
+    targetCpu.filter(_.nonEmpty).toList.map { cpu =>
+      TargetAbi.fromHint(Some(targetTriple)) match
+        case TargetAbi.X86_64 => s"-march=$cpu"
+        case _ => s"-mcpu=$cpu"
+    }
+
   private def timedStep[A](
     name:         String,
     recordTiming: Option[TimingRecorder]
@@ -67,7 +86,7 @@ object LlvmToolchain:
       case Some(record) =>
         IO.delay(System.nanoTime()).flatMap { start =>
           io.guarantee(
-            IO.delay(record(PipelineTiming(name, System.nanoTime() - start)))
+            IO.delay(record(PipelineTiming(name, System.nanoTime() - start, start)))
           )
         }
 
@@ -247,6 +266,129 @@ object LlvmToolchain:
       recordTiming = Some(record)
     ).map(result => result -> timings.result())
 
+  /** Compiles an executable from in-memory IR with a single clang invocation.
+    *
+    * The IR is piped to `clang -x ir -` and linked with the runtime bitcode through lld's LTO,
+    * which does the whole-program optimization and internalization that `opt` and `llc` do in
+    * the step-by-step pipeline, without the intermediate `.ll`, `.bc` and `.s` files.
+    */
+  def compileIr(
+    ir:             String,
+    programName:    String,
+    config:         CompilerConfig,
+    resolvedTriple: Option[String],
+    targetCpu:      Option[String]
+  ): IO[Either[LlvmCompilationError, Int]] =
+    compileIrInternal(ir, programName, config, resolvedTriple, targetCpu, recordTiming = None)
+
+  def compileIrWithTimings(
+    ir:             String,
+    programName:    String,
+    config:         CompilerConfig,
+    resolvedTriple: Option[String],
+    targetCpu:      Option[String]
+  ): IO[(Either[LlvmCompilationError, Int], Vector[PipelineTiming])] =
+    val timings = Vector.newBuilder[PipelineTiming]
+    val record: TimingRecorder = timing => timings += timing
+    compileIrInternal(
+      ir,
+      programName,
+      config,
+      resolvedTriple,
+      targetCpu,
+      recordTiming = Some(record)
+    ).map(result => result -> timings.result())
+
+  private def compileIrInternal(
+    ir:             String,
+    programName:    String,
+    config:         CompilerConfig,
+    resolvedTriple: Option[String],
+    targetCpu:      Option[String],
+    recordTiming:   Option[TimingRecorder]
+  ): IO[Either[LlvmCompilationError, Int]] =
+    for
+      _ <- IO(logModule(s"Compiling module $programName", config.printPhases))
+      _ <- IO(logInfo(s"Working directory: ${config.outputDir}", config.printPhases))
+      _ <- createOutputDir(config.outputDir, config.printPhases)
+      targetTripleResult <- detectOsTargetTriple(resolvedTriple)
+      result <- targetTripleResult match
+        case Left(error) =>
+          IO(logError(s"Error detecting target triple: $error")) *>
+            IO.pure(error.asLeft)
+        case Right(triple) =>
+          val outputDir = config.outputDir.resolve("out").resolve(triple)
+          val targetDir = config.outputDir.resolve("target")
+          val clangFlags =
+            clangStackProbeFlags(config.noStackCheck) ++ clangAsanFlags(config.asan) ++
+              clangThreadFlags
+          for
+            _ <- createOutputDir(outputDir, config.printPhases)
+            _ <- createOutputDir(targetDir, config.printPhases)
+            runtimeResult <- timedStep("llvm-runtime-bitcode", recordTiming)(
+              compileRuntimeBitcode(outputDir, triple, config, clangFlags)
+            )
+            result <- runtimeResult match
+              case Left(error) => IO.pure(error.asLeft)
+              case Right(runtimePath) =>
+                linkIrWithClang(
+                  ir,
+                  programName,
+                  triple,
+                  config,
+                  targetDir,
+                  runtimePath,
+                  targetCpu,
+                  clangFlags,
+                  recordTiming
+                )
+          yield result
+    yield result
+
+  private def linkIrWithClang(
+    ir:           String,
+    programName:  String,
+    targetTriple: String,
+    config:       CompilerConfig,
+    targetDir:    Path,
+    runtimePath:  String,
+    targetCpu:    Option[String],
+    clangFlags:   List[String],
+    recordTiming: Option[TimingRecorder]
+  ): IO[Either[LlvmCompilationError, Int]] =
+    val outputPath = executablePath(programName, targetTriple, config, targetDir)
+    logPhase(s"Compiling and linking executable (single clang, LTO)", config.printPhases)
+    logDebug(s"Runtime bitcode: $runtimePath", config.verbose)
+    logDebug(s"Output file: $outputPath", config.verbose)
+
+    // The runtime goes straight to lld (-Wl,) so clang doesn't run it through the
+    // pre-link pipeline again.
+    val cmd = (List(
+      "clang",
+      "-target",
+      targetTriple,
+      "-fuse-ld=lld",
+      "-flto",
+      s"-O${config.optLevel}"
+    ) ++ runtimeCpuFlags(targetTriple, targetCpu) ++ clangFlags ++
+      List("-x", "ir", "-", s"-Wl,$runtimePath", "-o", outputPath.toString)).mkString(" ")
+
+    IO.blocking(Option(outputPath.getParent).foreach(Files.createDirectories(_))) *>
+      timedStep("llvm-clang-lto", recordTiming)(
+        executeCommand(
+          cmd,
+          "Failed to compile and link",
+          config.outputDir,
+          config.verbose,
+          input = Some(ir.getBytes(StandardCharsets.UTF_8))
+        )
+      ).map {
+        case Left(error) => error.asLeft
+        case Right(_) =>
+          logInfo(s"Native code generation successful. Exit code: 0", config.printPhases)
+          0.asRight
+      }
+
   private def compileInternal(
     llvmIrPath:     Path,
     config:         CompilerConfig,
@@ -343,7 +485,8 @@ object LlvmToolchain:
     import cats.data.EitherT
 
     val programBitcode = outputDir.resolve(s"$programName.bc").toAbsolutePath.toString
-    val clangFlags     = clangStackProbeFlags(config.noStackCheck) ++ clangAsanFlags(config.asan)
+    val clangFlags =
+      clangStackProbeFlags(config.noStackCheck) ++ clangAsanFlags(config.asan) ++ clangThreadFlags
 
     (for
       _ <- EitherT(
@@ -509,163 +652,299 @@ object LlvmToolchain:
   /** Filename for the MML runtime file */
   private val mmlRuntimeFilename = "mml_runtime.c"
 
+  /** Suffix that keeps runtimes built for different `--target-cpu` values apart */
+  private def mmlRuntimeCpuSuffix(targetCpu: Option[String]): String =
+    targetCpu.filter(_.nonEmpty).map(cpu => s"-$cpu").getOrElse("")
+
   /** Get the filename for the compiled MML runtime object for a specific target */
-  private def mmlRuntimeObjectFilename(targetTriple: String): String =
-    s"mml_runtime-$targetTriple.o"
+  private def mmlRuntimeObjectFilename(targetTriple: String, targetCpu: Option[String]): String =
+    s"mml_runtime-$targetTriple${mmlRuntimeCpuSuffix(targetCpu)}.o"
 
-  /** Get the filename for the compiled MML runtime bitcode for a specific target */
-  private def mmlRuntimeBitcodeFilename(targetTriple: String): String =
-    s"mml_runtime-$targetTriple.bc"
+  /** Loads the runtime source from the classpath, falling back to the source tree. */
+  private def loadRuntimeSource(verbose: Boolean): IO[Either[LlvmCompilationError, Array[Byte]]] =
+    IO.blocking {
+      try
+        val classLoader = getClass.getClassLoader
+        val paths = List(
+          mmlRuntimeResourcePath,
+          s"/$mmlRuntimeResourcePath",
+          s"modules/mmlc-lib/src/main/resources/$mmlRuntimeResourcePath",
+          s"/modules/mmlc-lib/src/main/resources/$mmlRuntimeResourcePath"
+        )
+
+        val stream = paths.foldLeft[Option[InputStream]](None) { (acc, path) =>
+          acc.orElse {
+            val s = Option(classLoader.getResourceAsStream(path))
+            if s.isDefined then logDebug(s"Found resource at path: $path", verbose)
+            s
+          }
+        }
 
+        val resourceStream = stream.getOrElse {
+          val localPath = Paths.get("modules/mmlc-lib/src/main/resources", mmlRuntimeResourcePath)
+          logDebug(s"Trying to read from file system at: $localPath", verbose)
+          if Files.exists(localPath) then
+            logDebug(s"Found file at: $localPath", verbose)
+            Files.newInputStream(localPath)
+          else
+            // FIXME:QA: Exceptions are not allowed in this codebase.
+            throw new Exception(
+              s"Could not find resource: $mmlRuntimeResourcePath (tried multiple paths)"
+            )
+        }
+
+        try resourceStream.readAllBytes().asRight
+        finally resourceStream.close()
+      catch
+        case e: Exception =>
+          val error = LlvmCompilationError.RuntimeResourceError(
+            s"Failed to load runtime source: ${e.getMessage}"
+          )
+          logError(error.toString)
+          error.asLeft
+    }
+
+  /** Writes the runtime source to `outputDir`, replacing a copy left by another compiler
+    * version.
+    */
   private def extractRuntimeResource(
-    outputDir:   Path,
-    verbose:     Boolean,
-    printPhases: Boolean
-  ): IO[Either[LlvmCompilationError, String]] = IO.defer {
+    outputDir: Path,
+    source:    Array[Byte],
+    verbose:   Boolean
+  ): IO[Either[LlvmCompilationError, String]] = IO.blocking {
     val sourcePath = outputDir.resolve(mmlRuntimeFilename).toAbsolutePath
+    try
+      if Files.exists(sourcePath) && java.util.Arrays.equals(Files.readAllBytes(sourcePath), source)
+      then logDebug(s"Runtime source already up to date at $sourcePath", verbose)
+      else
+        logDebug(s"Extracting runtime source to: $sourcePath", verbose)
+        Files.write(sourcePath, source)
+      sourcePath.toString.asRight
+    catch
+      case e: Exception =>
+        val error = LlvmCompilationError.RuntimeResourceError(
+          s"Failed to extract runtime source: ${e.getMessage}"
+        )
+        logError(error.toString)
+        error.asLeft
+  }
 
-    if Files.exists(sourcePath) then
-      logDebug(s"Runtime source already exists at $sourcePath", verbose)
-      IO.pure(sourcePath.toString.asRight)
-    else
-      IO.blocking {
-        try
-          logPhase("Extracting MML runtime source", printPhases)
-          logDebug(s"Destination: $sourcePath", verbose)
-
-          val resourceStream =
-            val classLoader = getClass.getClassLoader
-            val paths = List(
-              mmlRuntimeResourcePath,
-              s"/$mmlRuntimeResourcePath",
-              s"modules/mmlc-lib/src/main/resources/$mmlRuntimeResourcePath",
-              s"/modules/mmlc-lib/src/main/resources/$mmlRuntimeResourcePath"
-            )
+  /** Shared cache for compiled runtimes: `$MML_CACHE_DIR`, else the user cache directory. */
+  private def runtimeCacheDir: Option[Path] =
+    def nonEmpty(name: String) = sys.env.get(name).filter(_.nonEmpty)
+    val home = Option(System.getProperty("user.home")).filter(_.nonEmpty)
+    val base = nonEmpty("MML_CACHE_DIR")
+      .map(Paths.get(_))
+      .orElse(nonEmpty("XDG_CACHE_HOME").map(Paths.get(_, "mml")))
+      .orElse(
+        home.map { h =>
+          if System.getProperty("os.name", "").startsWith("Mac") then
+            Paths.get(h, "Library", "Caches", "mml")
+          else Paths.get(h, ".cache", "mml")
+        }
+      )
+    base.map(_.resolve("runtime").toAbsolutePath)
 
-            val stream = paths.foldLeft[Option[InputStream]](None) { (acc, path) =>
-              acc.orElse {
-                val s = Option(classLoader.getResourceAsStream(path))
-                if s.isDefined then logDebug(s"Found resource at path: $path", verbose)
-                s
+  /** Identifies the clang that compiles the runtime: its version banner, plus the binary `clang`
+    * resolves to on `PATH` and its modification time. The banner alone misses a rebuilt or
+    * swapped clang that reports the same version.
+    */
+  private def clangIdentity: IO[String] = IO.blocking {
+    val banner =
+      try Process("clang --version").!!.trim
+      catch case _: Exception => "unknown"
+    val binary =
+      try
+        sys.env
+          .get("PATH")
+          .toList
+          .flatMap(_.split(File.pathSeparator))
+          .map(dir => Paths.get(dir, "clang"))
+          .find(Files.isExecutable(_))
+          .map { path =>
+            val real = path.toRealPath()
+            s"$real ${Files.getLastModifiedTime(real).toMillis}"
+          }
+      catch case _: Exception => None
+    (banner :: binary.toList).mkString("\n")
+  }
+
+  /** The cache-key form of `flags`: `-march=native` / `-mcpu=native` stand for whatever CPU the
+    * build runs on, so they are replaced by the `-target-cpu` and `-target-feature` arguments
+    * clang resolves them to here. A runtime built on one machine is then not reused on another
+    * through a shared cache directory.
+    */
+  private def resolveNativeCpu(targetTriple: String, flags: List[String]): IO[List[String]] =
+    flags.find(flag => flag == "-march=native" || flag == "-mcpu=native") match
+      case None => IO.pure(flags)
+      case Some(native) =>
+        IO.blocking {
+          val output = new StringBuilder
+          val logger = ProcessLogger(_ => (), line => output.append(line).append('\n'))
+          val probe = List("clang", "-target", targetTriple, native, "-###") ++
+            List("-x", "c", "-c", "/dev/null", "-o", "/dev/null")
+          val resolved =
+            try
+              Process(probe).!(logger)
+              val args = "\"([^\"]*)\"".r.findAllMatchIn(output).map(_.group(1)).toList
+              args.sliding(2).toList.collect {
+                case List("-target-cpu", cpu) => s"-target-cpu=$cpu"
+                case List("-target-feature", feature) => feature
               }
+            catch case _: Exception => Nil
+          if resolved.isEmpty then flags
+          else flags.flatMap(flag => if flag == native then resolved else List(flag))
+        }
+
+  /** Content hash over everything that changes the compiled runtime. */
+  private def runtimeCacheKey(source: Array[Byte], parts: List[String]): String =
+    val digest = MessageDigest.getInstance("SHA-256")
+    digest.update(source)
+    parts.foreach { part =>
+      digest.update(0.toByte)
+      digest.update(part.getBytes(StandardCharsets.UTF_8))
+    }
+    digest.digest().take(12).map(b => f"${b & 0xff}%02x").mkString
+
+  /** Returns the compiled runtime for these flags, building it on a cache miss.
+    *
+    * Artifacts live in the shared cache directory (falling back to `outputDir` when it can't be
+    * created) under a name carrying the cache key, so upgrades and flag changes never pick up a
+    * stale runtime. A miss compiles to a temporary file and renames it into place, which keeps
+    * concurrent builds from seeing a partial artifact.
+    */
+  private def cachedRuntimeArtifact(
+    kind:         String,
+    extension:    String,
+    outputDir:    Path,
+    targetTriple: String,
+    config:       CompilerConfig,
+    compileFlags: List[String]
+  ): IO[Either[LlvmCompilationError, String]] =
+    loadRuntimeSource(config.verbose).flatMap {
+      case Left(error) => IO.pure(error.asLeft)
+      case Right(source) =>
+        for
+          clang    <- clangIdentity
+          keyFlags <- resolveNativeCpu(targetTriple, compileFlags)
+          key = runtimeCacheKey(source, clang :: targetTriple :: keyFlags)
+          cacheDir <- IO.blocking {
+            runtimeCacheDir.filter { dir =>
+              try
+                Files.createDirectories(dir)
+                Files.isWritable(dir)
+              catch case _: Exception => false
             }
+          }
+          dir      = cacheDir.getOrElse(outputDir.toAbsolutePath)
+          artifact = dir.resolve(s"mml_runtime-$targetTriple-$key.$extension")
+          result <-
+            if Files.exists(artifact) then
+              IO(logInfo(s"Runtime $kind cached at $artifact", config.printPhases))
+                .as(artifact.toString.asRight)
+            else
+              extractRuntimeResource(outputDir, source, config.verbose).flatMap {
+                case Left(error) => IO.pure(error.asLeft)
+                case Right(sourcePath) =>
+                  storeRuntimeArtifact(
+                    kind,
+                    dir,
+                    artifact,
+                    sourcePath,
+                    targetTriple,
+                    config,
+                    compileFlags
+                  )
+              }
+        yield result
+    }
 
-            stream.getOrElse {
-              val localPath =
-                Paths.get("modules/mmlc-lib/src/main/resources", mmlRuntimeResourcePath)
-              logDebug(s"Trying to read from file system at: $localPath", verbose)
-              if Files.exists(localPath) then
-                logDebug(s"Found file at: $localPath", verbose)
-                Files.newInputStream(localPath)
-              else
-                // FIXME:QA: Exceptions are not allowed in this codebase.
-                throw new Exception(
-                  s"Could not find resource: $mmlRuntimeResourcePath (tried multiple paths)"
+  /** Compiles the runtime into a fresh temporary file in `dir` and renames it to `artifact`. The
+    * temporary name is unique, so concurrent builds never write the same file.
+    */
+  private def storeRuntimeArtifact(
+    kind:         String,
+    dir:          Path,
+    artifact:     Path,
+    sourcePath:   String,
+    targetTriple: String,
+    config:       CompilerConfig,
+    compileFlags: List[String]
+  ): IO[Either[LlvmCompilationError, String]] =
+    def storeError(e: Throwable): Either[LlvmCompilationError, String] =
+      val error = LlvmCompilationError.RuntimeResourceError(
+        s"Failed to store runtime $kind in $dir: ${e.getMessage}"
+      )
+      logError(error.toString)
+      error.asLeft
+
+    IO.blocking(Files.createTempFile(dir, s"${artifact.getFileName}.", ".tmp")).attempt.flatMap {
+      case Left(e) => IO.pure(storeError(e))
+      case Right(tmp) =>
+        logPhase(s"Compiling MML runtime $kind", config.printPhases)
+        logDebug(s"Input file: $sourcePath", config.verbose)
+        logDebug(s"Output file: $artifact", config.verbose)
+        val cmd =
+          (List("clang", "-target", targetTriple) ++ compileFlags ++
+            List("-o", tmp.toString, sourcePath)).mkString(" ")
+        executeCommand(
+          cmd,
+          s"Failed to compile MML runtime $kind",
+          config.outputDir,
+          config.verbose
+        ).flatMap {
+          case Left(error) => IO.blocking(Files.deleteIfExists(tmp)).attempt.as(error.asLeft[String])
+          case Right(_) =>
+            IO.blocking {
+              try
+                Files.move(
+                  tmp,
+                  artifact,
+                  StandardCopyOption.REPLACE_EXISTING,
+                  StandardCopyOption.ATOMIC_MOVE
                 )
+                artifact.toString.asRight
+              catch
+                case e: Exception =>
+                  Files.deleteIfExists(tmp)
+                  storeError(e)
             }
-
-          Files.copy(resourceStream, sourcePath, StandardCopyOption.REPLACE_EXISTING)
-          resourceStream.close()
-          logDebug(s"Successfully extracted runtime source to: $sourcePath", verbose)
-          sourcePath.toString.asRight
-        catch
-          case e: Exception =>
-            val error = LlvmCompilationError.RuntimeResourceError(
-              s"Failed to extract runtime source: ${e.getMessage}"
-            )
-            logError(error.toString)
-            error.asLeft
-      }
-  }
+        }
+    }
 
   private def compileRuntime(
     outputDir:    Path,
     targetTriple: String,
     config:       CompilerConfig,
     clangFlags:   List[String]
-  ): IO[Either[LlvmCompilationError, String]] = IO.defer {
-    val runtimeFilename = mmlRuntimeObjectFilename(targetTriple)
-    val objPath         = outputDir.resolve(runtimeFilename).toAbsolutePath
-
-    logPhase("Compiling runtime", config.printPhases)
-    if Files.exists(objPath) then
-      logInfo(
-        s"Runtime object already exists at $objPath, skipping compilation",
-        config.printPhases
-      )
-      IO.pure(objPath.toString.asRight)
-    else
-      for
-        sourceResult <- extractRuntimeResource(outputDir, config.verbose, config.printPhases)
-        result <- sourceResult match
-          case Left(error) => IO.pure(error.asLeft)
-          case Right(sourcePath) =>
-            logPhase("Compiling MML runtime", config.printPhases)
-            logDebug(s"Input file: $sourcePath", config.verbose)
-            logDebug(s"Output file: $objPath", config.verbose)
-
-            val cmd = (List(
-              "clang",
-              "-target",
-              targetTriple,
-              "-c",
-              "-std=c17",
-              s"-O${config.optLevel}",
-              "-flto"
-            ) ++ clangFlags ++ List("-fPIC", "-o", objPath.toString, sourcePath)).mkString(" ")
-            executeCommand(cmd, "Failed to compile MML runtime", config.outputDir, config.verbose)
-              .map {
-                case Left(error) => error.asLeft
-                case Right(_) => objPath.toString.asRight
-              }
-      yield result
-  }
+  ): IO[Either[LlvmCompilationError, String]] =
+    cachedRuntimeArtifact(
+      "object",
+      "o",
+      outputDir,
+      targetTriple,
+      config,
+      List("-c", "-std=c17", s"-O${config.optLevel}", "-flto") ++
+        runtimeCpuFlags(targetTriple, config.targetCpu) ++ clangStatsFlags(config.runtimeStats) ++
+        clangFlags ++ List("-fPIC")
+    )
 
   private def compileRuntimeBitcode(
     outputDir:    Path,
     targetTriple: String,
     config:       CompilerConfig,
     clangFlags:   List[String]
-  ): IO[Either[LlvmCompilationError, String]] = IO.defer {
-    val runtimeFilename = mmlRuntimeBitcodeFilename(targetTriple)
-    val bcPath          = outputDir.resolve(runtimeFilename).toAbsolutePath
-
-    logPhase("Compiling runtime bitcode", config.printPhases)
-    if Files.exists(bcPath) then
-      logInfo(s"Runtime bitcode present, skipping", config.printPhases)
-      IO.pure(bcPath.toString.asRight)
-    else
-      for
-        sourceResult <- extractRuntimeResource(outputDir, config.verbose, config.printPhases)
-        result <- sourceResult match
-          case Left(error) => IO.pure(error.asLeft)
-          case Right(sourcePath) =>
-            logPhase("Compiling runtime bitcode", config.printPhases)
-            logDebug(s"Input file: $sourcePath", config.verbose)
-            logDebug(s"Output file: $bcPath", config.verbose)
-
-            val cpuFlags = config.targetCpu.map(cpu => List(s"-mcpu=$cpu")).getOrElse(Nil)
-            val cmd = (List(
-              "clang",
-              "-target",
-              targetTriple,
-              "-emit-llvm",
-              "-c",
-              "-std=c17",
-              s"-O${config.optLevel}"
-            ) ++ cpuFlags ++ clangFlags ++ List("-fPIC", "-o", bcPath.toString, sourcePath))
-              .mkString(" ")
-            executeCommand(
-              cmd,
-              "Failed to compile MML runtime bitcode",
-              config.outputDir,
-              config.verbose
-            ).map {
-              case Left(error) => error.asLeft
-              case Right(_) => bcPath.toString.asRight
-            }
-      yield result
-  }
+  ): IO[Either[LlvmCompilationError, String]] =
+    cachedRuntimeArtifact(
+      "bitcode",
+      "bc",
+      outputDir,
+      targetTriple,
+      config,
+      List("-emit-llvm", "-c", "-std=c17", s"-O${config.optLevel}") ++
+        runtimeCpuFlags(targetTriple, config.targetCpu) ++ clangStatsFlags(config.runtimeStats) ++
+        clangFlags ++ List("-fPIC")
+    )
 
   private def linkRuntimeBitcode(
     programName:  String,
@@ -717,14 +996,8 @@ object LlvmToolchain:
       logDebug(s"Creating target directory: $targetDirPath", config.verbose)
       Files.createDirectories(targetDirPath)
 
-    val finalExecutablePath = config.outputName match
-      case Some(path) => Paths.get(path).toAbsolutePath.toString
-      case None =>
-        val baseName = programName.toLowerCase
-        val finalName =
-          if config.targetTriple.isDefined then s"$baseName-$targetTriple" else baseName
-        targetDirPath.resolve(finalName).toString
-    val inputFile = outputDir.resolve(s"$programName.s").toAbsolutePath.toString
+    val finalExecutablePath = executablePath(programName, targetTriple, config, targetDir).toString
+    val inputFile           = outputDir.resolve(s"$programName.s").toAbsolutePath.toString
 
     val outputPath = Paths.get(finalExecutablePath)
     val parentDir  = outputPath.getParent
@@ -755,6 +1028,23 @@ object LlvmToolchain:
         0.asRight
     }
 
+  /** `-o` when given, else the lowercased module name in `targetDir`, suffixed with the triple
+    * when cross-compiling.
+    */
+  private def executablePath(
+    programName:  String,
+    targetTriple: String,
+    config:       CompilerConfig,
+    targetDir:    Path
+  ): Path =
+    config.outputName match
+      case Some(path) => Paths.get(path).toAbsolutePath
+      case None =>
+        val baseName = programName.toLowerCase
+        val finalName =
+          if config.targetTriple.isDefined then s"$baseName-$targetTriple" else baseName
+        targetDir.toAbsolutePath.resolve(finalName)
+
   private def compileLibrary(
     programName:  String,
     targetTriple: String,
@@ -808,7 +1098,7 @@ object LlvmToolchain:
             case Left(error) => error.asLeft
             case Right(_) =>
               val runtimeTargetPath =
-                targetDirPath.resolve(mmlRuntimeObjectFilename(targetTriple)).toString
+                targetDirPath.resolve(mmlRuntimeObjectFilename(targetTriple, config.targetCpu)).toString
               logInfo(s"Copying runtime to $runtimeTargetPath", config.printPhases)
               try
                 Files.copy(
@@ -818,7 +1108,7 @@ object LlvmToolchain:
                 )
                 logInfo(s"Library object generation successful. Exit code: 0", config.printPhases)
                 logInfo(
-                  s"Note: Link with ${mmlRuntimeObjectFilename(targetTriple)} when using this library.",
+                  s"Note: Link with ${mmlRuntimeObjectFilename(targetTriple, config.targetCpu)} when using this library.",
                   config.printPhases
                 )
                 0.asRight
@@ -859,11 +1149,13 @@ object LlvmToolchain:
           else LlvmCompilationError.UnsupportedOperatingSystem(os).asLeft
     }
 
+  /** Runs `cmd` in `workingDir`; `input`, when given, is fed to its stdin. */
   private def executeCommand(
     cmd:        String,
     errorMsg:   String,
     workingDir: Path,
-    verbose:    Boolean
+    verbose:    Boolean,
+    input:      Option[Array[Byte]] = None
   ): IO[Either[LlvmCompilationError, Int]] =
     IO.defer {
       val setupDir = IO.blocking {
@@ -880,7 +1172,10 @@ object LlvmToolchain:
       setupDir.flatMap { workingDirFile =>
         IO.blocking {
           try
-            val exitCode = Process(cmd, workingDirFile).!
+            val process = Process(cmd, workingDirFile)
+            val exitCode = input match
+              case Some(bytes) => (process #< new ByteArrayInputStream(bytes)).!
+              case None => process.!
             if exitCode != 0 then
               val error = LlvmCompilationError.CommandExecutionError(cmd, errorMsg, exitCode)
               logError(s"Command failed with exit code $exitCode: $error")
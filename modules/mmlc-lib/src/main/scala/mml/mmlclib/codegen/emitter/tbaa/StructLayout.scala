@@ -62,6 +62,68 @@ object StructLayout:
       case other =>
         Left(CodeGenError(s"Cannot compute alignment for: ${other.getClass.getSimpleName}"))
 
+  /** Size the runtime's small-string optimisation assumes for `String`. Short strings are stored
+    * inline in the struct with a tag in the last byte, which overlaps the top byte of `data`, so the
+    * struct must stay exactly `{length: i64, data: ptr}` with the pointer last.
+    */
+  val StringStructSize: Int = 16
+
+  /** Check that a `String` NativeStruct still matches the runtime's inline-string layout. */
+  def checkStringLayout(
+    fields:      List[(String, Type)],
+    resolvables: ResolvablesIndex
+  ): Either[CodeGenError, Unit] =
+    for
+      size <- computeStructSize(fields, resolvables)
+      lastIsPointer = fields.lastOption.exists((_, t) => isPointer(t, resolvables))
+      _ <- Either.cond(
+        size == StringStructSize && lastIsPointer,
+        (),
+        CodeGenError(
+          s"String layout must be $StringStructSize bytes ending in a pointer field " +
+            s"(runtime inline strings rely on it), got $size bytes"
+        )
+      )
+    yield ()
+
+  /** Size of every runtime array struct. The runtime expands all array families from one template
+    * over `{int64_t length; T *data;}`, so each `*Array` NativeStruct must keep that shape whatever
+    * its element type.
+    */
+  val ArrayStructSize: Int = 16
+
+  /** Check that an array NativeStruct is `{length: Int64, data: <pointer>}`. */
+  def checkArrayLayout(
+    name:        String,
+    fields:      List[(String, Type)],
+    resolvables: ResolvablesIndex
+  ): Either[CodeGenError, Unit] =
+    for
+      size <- computeStructSize(fields, resolvables)
+      shapeOk = fields match
+        case List(("length", lengthType), ("data", dataType)) =>
+          sizeOf(lengthType, resolvables).contains(8) && isPointer(dataType, resolvables)
+        case _ => false
+      _ <- Either.cond(
+        size == ArrayStructSize && shapeOk,
+        (),
+        CodeGenError(
+          s"$name layout must be {length: Int64, data: <pointer>} ($ArrayStructSize bytes, " +
+            s"shared by the runtime array template), got $size bytes"
+        )
+      )
+    yield ()
+
+  private def isPointer(typeSpec: Type, resolvables: ResolvablesIndex): Boolean =
+    typeSpec match
+      case _: NativePointer => true
+      case TypeRef(_, _, resolvedId, _) =>
+        resolvedId.flatMap(resolvables.lookupType).exists {
+          case td: TypeDef => td.typeSpec.exists(_.isInstanceOf[NativePointer])
+          case _ => false
+        }
+      case _ => false
+
   /** Compute total size of a struct including tail padding. */
   private def computeStructSize(
     fields:      List[(String, Type)],
@@ -102,12 +102,21 @@ object TbaaEmitter:
   ): Either[CodeGenError, CodeGenState] =
     typeDef.typeSpec match
       case Some(ns: NativeStruct) =>
-        computeStructFieldLayout(typeDef.name, ns.fields, state.resolvables).map { layout =>
+        for
+          _ <-
+            if typeDef.name == "String" then StructLayout.checkStringLayout(ns.fields, state.resolvables)
+            else if isStdlibArray(typeDef) then
+              StructLayout.checkArrayLayout(typeDef.name, ns.fields, state.resolvables)
+            else Right(())
+          layout <- computeStructFieldLayout(typeDef.name, ns.fields, state.resolvables)
+        yield
           val (stateWithTbaa, _) = state.getTbaaStruct(typeDef.name, layout)
           stateWithTbaa
-        }
       case _ => Right(state)
 
+  private def isStdlibArray(typeDef: TypeDef): Boolean =
+    typeDef.name.endsWith("Array") && typeDef.id.exists(_.startsWith("stdlib::"))
+
   def ensureTbaaStructForTypeStruct(
     typeStruct: TypeStruct,
     state:      CodeGenState
@@ -0,0 +1,32 @@
+package mml.mmlclib.compiler
+
+import mml.mmlclib.ast.*
+
+/** Size of a module's AST, reported as counters so profiles can relate phase times to input size.
+  */
+object AstCounters:
+
+  def counters(stage: String, module: Module): List[Counter] =
+    List(
+      Counter(stage, "ast-members", module.members.size.toLong),
+      Counter(stage, "ast-terms", module.members.foldLeft(0L)(_ + termsInMember(_)))
+    )
+
+  private def termsInMember(member: Member): Long = member match
+    case bnd:       Bnd => termsIn(bnd.value)
+    case duplicate: DuplicateMember => termsInMember(duplicate.originalMember)
+    case invalid:   InvalidMember => termsInMember(invalid.originalMember)
+    case _ => 0L
+
+  private def termsIn(term: Term): Long =
+    val children = term match
+      case expr:    Expr => expr.terms.foldLeft(0L)(_ + termsIn(_))
+      case cond:    Cond => termsIn(cond.cond) + termsIn(cond.ifTrue) + termsIn(cond.ifFalse)
+      case app:     App => termsIn(app.fn) + termsIn(app.arg)
+      case lambda:  Lambda => termsIn(lambda.body)
+      case group:   TermGroup => termsIn(group.inner)
+      case tuple:   Tuple => tuple.elements.foldLeft(0L)(_ + termsIn(_))
+      case ref:     Ref => ref.qualifier.fold(0L)(termsIn)
+      case invalid: InvalidExpression => termsIn(invalid.originalExpr)
+      case _ => 0L
+    1L + children
@@ -2,6 +2,7 @@ package mml.mmlclib.compiler
 
 import cats.effect.IO
 import mml.mmlclib.codegen.{
+  CompilationMode,
   LlvmCompilationError,
   LlvmIrEmitter,
   LlvmToolchain,
@@ -110,6 +111,10 @@ object CodegenStage:
     val targetAbi = TargetAbi.fromHint(hint)
     (targetAbi, state)
 
+  /** `--single-clang` covers executables; `--emit-opt-ir` needs the step-by-step pipeline. */
+  private def usesSingleClang(config: CompilerConfig): Boolean =
+    config.singleClang && config.mode == CompilationMode.Exe && !config.emitOptIr
+
   private def llvmIrPath(state: CompilerState): Path =
     val triple = state.resolvedTriple.getOrElse("unknown")
     state.config.outputDir.resolve(s"${state.module.name}-$triple.ll")
@@ -118,6 +123,7 @@ object CodegenStage:
     state.llvmIr match
       case None => IO.pure(state)
       case _ if !state.canEmitCode => IO.pure(state)
+      case _ if usesSingleClang(state.config) => IO.pure(state) // piped to clang instead
       case Some(ir) =>
         val path = llvmIrPath(state)
         IO.blocking {
@@ -142,18 +148,29 @@ object CodegenStage:
     else
       val irPath    = llvmIrPath(state)
       val targetCpu = resolveTargetCpu(state.config)
-
-      val compileIo =
-        if state.config.showTimings then
-          LlvmToolchain.compileWithTimings(irPath, state.config, state.resolvedTriple, targetCpu)
-        else
-          LlvmToolchain
-            .compile(irPath, state.config, state.resolvedTriple, targetCpu)
-            .map(_ -> Vector.empty[PipelineTiming])
+      val config    = state.config
+      val triple    = state.resolvedTriple
+
+      val compileIo = (state.llvmIr, usesSingleClang(config)) match
+        case (Some(ir), true) =>
+          val name = state.module.name
+          if config.collectsTimings then
+            LlvmToolchain.compileIrWithTimings(ir, name, config, triple, targetCpu)
+          else
+            LlvmToolchain
+              .compileIr(ir, name, config, triple, targetCpu)
+              .map(_ -> Vector.empty[PipelineTiming])
+        case _ =>
+          if config.collectsTimings then
+            LlvmToolchain.compileWithTimings(irPath, config, triple, targetCpu)
+          else
+            LlvmToolchain
+              .compile(irPath, config, triple, targetCpu)
+              .map(_ -> Vector.empty[PipelineTiming])
 
       compileIo.map { case (result, stepTimings) =>
         val withSteps = stepTimings.foldLeft(state) { (s, t) =>
-          s.addTiming("llvm", t.name, t.durationNanos)
+          s.addTiming(Timing("llvm", t.name, t.durationNanos, startNanos = t.startNanos))
         }
         result match
           case Left(error) => withSteps.addError(error)
@@ -22,6 +22,22 @@ object Compilation:
       case Left(_) => emptyState(moduleName, content, config)
     }
 
+  /** `compileSource`, reusing the state of an identical earlier compile held by `cache`. */
+  def compileSourceCached(
+    cache:      FrontEndCache,
+    content:    String,
+    moduleName: String,
+    sourcePath: String,
+    config:     CompilerConfig
+  ): IO[CompilerState] =
+    val key = FrontEndCache.Key(content, moduleName, Some(sourcePath), config)
+    cache
+      .getOrCompile(key)(FrontEndApi.compile(content, moduleName, config, Some(sourcePath)).value)
+      .map {
+        case Right(state) => state
+        case Left(_) => emptyState(moduleName, content, config)
+      }
+
   /** Compile a file from disk. */
   def compileFile(path: Path, config: CompilerConfig): IO[Either[String, CompilerState]] =
     val moduleName = moduleNameFromPath(path)
@@ -19,8 +19,14 @@ case class CompilerConfig(
   printPhases:     Boolean,
   optLevel:        Int,
   emitScopedAlias: Boolean,
-  asan:            Boolean
-)
+  asan:            Boolean,
+  singleClang:     Boolean,
+  profileOut:      Option[Path],
+  runtimeStats:    Boolean
+):
+
+  /** Per-step timings are recorded for `--metrics` and for `--profile-out`. */
+  def collectsTimings: Boolean = showTimings || profileOut.isDefined
 
 object CompilerConfig:
 
@@ -40,7 +46,10 @@ object CompilerConfig:
       printPhases     = false,
       optLevel        = 3,
       emitScopedAlias = false,
-      asan            = false
+      asan            = false,
+      singleClang     = false,
+      profileOut      = None,
+      runtimeStats    = false
     )
 
   def exe(
@@ -57,7 +66,10 @@ object CompilerConfig:
     printPhases:     Boolean        = false,
     optLevel:        Int            = 3,
     emitScopedAlias: Boolean        = false,
-    asan:            Boolean        = false
+    asan:            Boolean        = false,
+    singleClang:     Boolean        = false,
+    profileOut:      Option[Path]   = None,
+    runtimeStats:    Boolean        = false
   ): CompilerConfig =
     CompilerConfig(
       mode            = CompilationMode.Exe,
@@ -74,7 +86,10 @@ object CompilerConfig:
       printPhases     = printPhases,
       optLevel        = optLevel,
       emitScopedAlias = emitScopedAlias,
-      asan            = asan
+      asan            = asan,
+      singleClang     = singleClang,
+      profileOut      = profileOut,
+      runtimeStats    = runtimeStats
     )
 
   def library(
@@ -91,7 +106,10 @@ object CompilerConfig:
     printPhases:     Boolean        = false,
     optLevel:        Int            = 3,
     emitScopedAlias: Boolean        = false,
-    asan:            Boolean        = false
+    asan:            Boolean        = false,
+    singleClang:     Boolean        = false,
+    profileOut:      Option[Path]   = None,
+    runtimeStats:    Boolean        = false
   ): CompilerConfig =
     CompilerConfig(
       mode            = CompilationMode.Library,
@@ -108,14 +126,18 @@ object CompilerConfig:
       printPhases     = printPhases,
       optLevel        = optLevel,
       emitScopedAlias = emitScopedAlias,
-      asan            = asan
+      asan            = asan,
+      singleClang     = singleClang,
+      profileOut      = profileOut,
+      runtimeStats    = runtimeStats
     )
 
   def ast(
     outputDir:   String,
-    verbose:     Boolean = false,
-    showTimings: Boolean = false,
-    noTco:       Boolean = false
+    verbose:     Boolean      = false,
+    showTimings: Boolean      = false,
+    noTco:       Boolean      = false,
+    profileOut:  Option[Path] = None
   ): CompilerConfig =
     CompilerConfig(
       mode            = CompilationMode.Ast,
@@ -132,15 +154,19 @@ object CompilerConfig:
       printPhases     = false,
       optLevel        = 0,
       emitScopedAlias = false,
-      asan            = false
+      asan            = false,
+      singleClang     = false,
+      profileOut      = profileOut,
+      runtimeStats    = false
     )
 
   def ir(
     outputDir:   String,
-    verbose:     Boolean = false,
-    showTimings: Boolean = false,
-    outputAst:   Boolean = false,
-    noTco:       Boolean = false
+    verbose:     Boolean      = false,
+    showTimings: Boolean      = false,
+    outputAst:   Boolean      = false,
+    noTco:       Boolean      = false,
+    profileOut:  Option[Path] = None
   ): CompilerConfig =
     CompilerConfig(
       mode            = CompilationMode.Ir,
@@ -157,7 +183,10 @@ object CompilerConfig:
       printPhases     = false,
       optLevel        = 0,
       emitScopedAlias = false,
-      asan            = false
+      asan            = false,
+      singleClang     = false,
+      profileOut      = profileOut,
+      runtimeStats    = false
     )
 
   def dev(
@@ -179,5 +208,8 @@ object CompilerConfig:
       printPhases     = false,
       optLevel        = 0,
       emitScopedAlias = false,
-      asan            = false
+      asan            = false,
+      singleClang     = false,
+      profileOut      = None,
+      runtimeStats    = false
     )
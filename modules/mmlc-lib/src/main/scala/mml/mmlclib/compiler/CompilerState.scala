@@ -6,7 +6,21 @@ import mml.mmlclib.errors.{CompilationError, CompilerWarning}
 import mml.mmlclib.parser.{ParserError, SourceInfo}
 import mml.mmlclib.semantic.SemanticError
 
-final case class Timing(stage: String, name: String, durationNanos: Long)
+import java.lang.management.ManagementFactory
+
+/** One timed step. `startNanos` is a `System.nanoTime` reading, only meaningful relative to the
+  * other timings of the same run. CPU time and allocation cover the thread that ran the step and
+  * are `None` for steps that may hop threads (IO phases, external tools) or when the JVM cannot
+  * measure them.
+  */
+final case class Timing(
+  stage:          String,
+  name:           String,
+  durationNanos:  Long,
+  startNanos:     Long         = 0L,
+  cpuNanos:       Option[Long] = None,
+  allocatedBytes: Option[Long] = None
+)
 
 final case class Counter(stage: String, name: String, value: Long)
 
@@ -63,6 +77,9 @@ case class CompilerState(
   def addTiming(stage: String, name: String, durationNanos: Long): CompilerState =
     copy(timings = timings :+ Timing(stage, name, durationNanos))
 
+  def addTiming(timing: Timing): CompilerState =
+    copy(timings = timings :+ timing)
+
   def addCounter(stage: String, name: String, value: Long): CompilerState =
     copy(counters = counters :+ Counter(stage, name, value))
 
@@ -90,6 +107,32 @@ object CompilerState:
       counters   = Vector.empty
     )
 
+  private val threadBean = ManagementFactory.getThreadMXBean
+
+  private final case class Probe(wall: Long, cpu: Option[Long], allocated: Option[Long])
+
+  private def probe(): Probe =
+    val allocated = threadBean match
+      case bean: com.sun.management.ThreadMXBean
+          if bean.isThreadAllocatedMemorySupported && bean.isThreadAllocatedMemoryEnabled =>
+        Some(bean.getCurrentThreadAllocatedBytes)
+      case _ => None
+    val cpu =
+      Option.when(threadBean.isCurrentThreadCpuTimeSupported)(threadBean.getCurrentThreadCpuTime)
+    Probe(System.nanoTime(), cpu, allocated)
+
+  /** Timing of a step that started at `start` and ran on the current thread. */
+  private def timingSince(stage: String, name: String, start: Probe): Timing =
+    val end = probe()
+    Timing(
+      stage          = stage,
+      name           = name,
+      durationNanos  = end.wall - start.wall,
+      startNanos     = start.wall,
+      cpuNanos       = end.cpu.zip(start.cpu).map(_ - _),
+      allocatedBytes = end.allocated.zip(start.allocated).map(_ - _)
+    )
+
   def timed[A](
     stage: String,
     name:  String
@@ -97,10 +140,9 @@ object CompilerState:
     f: CompilerState => (CompilerState, A)
   ): CompilerState => (CompilerState, A) =
     state =>
-      val start       = System.nanoTime()
+      val start       = probe()
       val (next, res) = f(state)
-      val duration    = System.nanoTime() - start
-      (next.addTiming(stage, name, duration), res)
+      (next.addTiming(timingSince(stage, name, start)), res)
 
   def timePhase(
     stage: String,
@@ -109,10 +151,9 @@ object CompilerState:
     f: CompilerState => CompilerState
   ): CompilerState => CompilerState =
     state =>
-      val start    = System.nanoTime()
-      val next     = f(state)
-      val duration = System.nanoTime() - start
-      next.addTiming(stage, name, duration)
+      val start = probe()
+      val next  = f(state)
+      next.addTiming(timingSince(stage, name, start))
 
   def timePhaseIO(
     stage: String,
@@ -123,6 +164,5 @@ object CompilerState:
     state =>
       val start = System.nanoTime()
       f(state).map { next =>
-        val duration = System.nanoTime() - start
-        next.addTiming(stage, name, duration)
+        next.addTiming(Timing(stage, name, System.nanoTime() - start, startNanos = start))
       }
@@ -0,0 +1,61 @@
+package mml.mmlclib.compiler
+
+import cats.effect.{IO, Ref}
+
+/** Recently compiled front-end states, keyed by source hash, module and config.
+  *
+  * The AST and `CompilerState` are immutable, so a hit hands back the earlier state as-is.
+  * DevLoop uses this to skip saves that didn't change the file; the LSP uses it when an edit
+  * (usually an undo) returns a document to a version it has already compiled. Only successful
+  * front-end runs are stored; the least recently used entry is dropped first.
+  */
+final class FrontEndCache private (
+  entries:  Ref[IO, Vector[(FrontEndCache.Key, CompilerState)]],
+  capacity: Int
+):
+
+  def getOrCompile[E](
+    key: FrontEndCache.Key
+  )(
+    compile: IO[Either[E, CompilerState]]
+  ): IO[Either[E, CompilerState]] =
+    entries
+      .modify { current =>
+        current.indexWhere(_._1 == key) match
+          case -1 => (current, None)
+          case i => (current(i) +: current.patch(i, Nil, 1), Some(current(i)._2))
+      }
+      .flatMap {
+        case Some(state) => IO.pure(Right(state))
+        case None =>
+          compile.flatTap {
+            case Right(state) =>
+              entries.update(current =>
+                ((key -> state) +: current.filterNot(_._1 == key)).take(capacity)
+              )
+            case Left(_) => IO.unit
+          }
+      }
+
+object FrontEndCache:
+
+  /** `sourceHash` comes first so a miss is usually decided without comparing the sources. */
+  case class Key(
+    sourceHash: Int,
+    source:     String,
+    moduleName: String,
+    sourcePath: Option[String],
+    config:     CompilerConfig
+  )
+
+  object Key:
+    def apply(
+      source:     String,
+      moduleName: String,
+      sourcePath: Option[String],
+      config:     CompilerConfig
+    ): Key =
+      Key(source.hashCode, source, moduleName, sourcePath, config)
+
+  def create(capacity: Int = 8): IO[FrontEndCache] =
+    Ref.of[IO, Vector[(Key, CompilerState)]](Vector.empty).map(new FrontEndCache(_, capacity))
@@ -28,6 +28,7 @@ object IngestStage:
         parseModule(source, sanitizedName, sourcePath)
       )
       |> CompilerState.timePhase("ingest", "lift-parse-errors")(ParsingErrorChecker.checkModule)
+      |> (current => current.addCounters(AstCounters.counters("ingest", current.module)))
 
   private def parseModule(
     source:     String,
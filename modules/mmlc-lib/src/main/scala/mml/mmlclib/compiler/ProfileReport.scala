@@ -0,0 +1,69 @@
+package mml.mmlclib.compiler
+
+import cats.effect.IO
+
+import java.nio.charset.StandardCharsets
+import java.nio.file.{Files, Path}
+
+/** Machine-readable form of the timings and counters that `--metrics` prints.
+  *
+  * The output is a Chrome trace-event file in the object format: `traceEvents` loads in
+  * chrome://tracing or Perfetto, and the `phases` and `counters` arrays carry the same data in a
+  * flat shape for dashboards. Trace viewers ignore the extra keys.
+  */
+object ProfileReport:
+
+  val formatVersion = 1
+
+  def toJson(state: CompilerState): ujson.Obj =
+    val origin = state.timings.map(_.startNanos).minOption.getOrElse(0L)
+
+    val phases = state.timings.map { timing =>
+      val phase = ujson.Obj(
+        "stage" -> timing.stage,
+        "name" -> timing.name,
+        "startNanos" -> (timing.startNanos - origin).toDouble,
+        "wallNanos" -> timing.durationNanos.toDouble
+      )
+      timing.cpuNanos.foreach(nanos => phase("cpuNanos") = nanos.toDouble)
+      timing.allocatedBytes.foreach(bytes => phase("allocatedBytes") = bytes.toDouble)
+      phase
+    }
+
+    val counters = state.counters.map { counter =>
+      ujson.Obj("stage" -> counter.stage, "name" -> counter.name, "value" -> counter.value.toDouble)
+    }
+
+    // Complete ("X") events use microseconds; the phase's own numbers go in `args`.
+    val traceEvents = state.timings.zip(phases).map { case (timing, phase) =>
+      ujson.Obj(
+        "name" -> timing.name,
+        "cat" -> timing.stage,
+        "ph" -> "X",
+        "ts" -> (timing.startNanos - origin) / 1000.0,
+        "dur" -> timing.durationNanos / 1000.0,
+        "pid" -> 1,
+        "tid" -> 1,
+        "args" -> phase
+      )
+    }
+
+    ujson.Obj(
+      "version" -> formatVersion,
+      "module" -> state.module.name,
+      "mode" -> state.config.mode.toString,
+      "optLevel" -> state.config.optLevel,
+      "succeeded" -> !state.hasErrors,
+      "totalWallNanos" -> state.timings.foldLeft(0L)(_ + _.durationNanos).toDouble,
+      "phases" -> ujson.Arr.from(phases),
+      "counters" -> ujson.Arr.from(counters),
+      "displayTimeUnit" -> "ms",
+      "traceEvents" -> ujson.Arr.from(traceEvents)
+    )
+
+  def write(path: Path, state: CompilerState): IO[Unit] =
+    IO.blocking {
+      Option(path.toAbsolutePath.getParent).foreach(Files.createDirectories(_))
+      Files.writeString(path, ujson.write(toJson(state), indent = 2), StandardCharsets.UTF_8)
+      ()
+    }
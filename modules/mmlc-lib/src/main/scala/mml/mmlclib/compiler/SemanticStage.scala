@@ -33,9 +33,13 @@ object SemanticStage:
       |> CompilerState.timePhase("semantic", "tailrec-detector")(
         TailRecursionDetector.rewriteModule
       )
+      |> CompilerState.timePhase("semantic", "bounds-check-elim")(
+        BoundsCheckEliminator.rewriteModule
+      )
       |> CompilerState.timePhase("semantic", "ownership-analyzer")(
         OwnershipAnalyzer.rewriteModule
       )
       |> CompilerState.timePhase("semantic", "resolvables-indexer-final")(
         ResolvablesIndexer.rewriteModule
       )
+      |> (current => current.addCounters(AstCounters.counters("semantic", current.module)))
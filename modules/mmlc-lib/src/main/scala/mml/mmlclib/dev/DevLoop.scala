@@ -2,7 +2,13 @@ package mml.mmlclib.dev
 
 import cats.effect.{ExitCode, IO}
 import mml.mmlclib.api.FrontEndApi
-import mml.mmlclib.compiler.{Compilation, CompilerConfig, CompilerState, FileOperations}
+import mml.mmlclib.compiler.{
+  Compilation,
+  CompilerConfig,
+  CompilerState,
+  FileOperations,
+  FrontEndCache
+}
 import mml.mmlclib.errors.CompilationError
 import mml.mmlclib.parser.{ParserError, SourceInfo}
 import mml.mmlclib.semantic.SemanticError
@@ -14,22 +20,23 @@ object DevLoop:
 
   def run(path: Path, config: CompilerConfig): IO[ExitCode] =
     for
-      _ <- initialCompile(path, config)
-      _ <- runWatchLoop(path, config)
+      cache <- FrontEndCache.create()
+      _ <- initialCompile(path, config, cache)
+      _ <- runWatchLoop(path, config, cache)
     yield ExitCode.Success
 
-  private def initialCompile(path: Path, config: CompilerConfig): IO[Unit] =
-    compileDev(path, config).flatMap {
+  private def initialCompile(path: Path, config: CompilerConfig, cache: FrontEndCache): IO[Unit] =
+    compileDev(path, config, cache).flatMap {
       case Right(_) => printSuccess()
       case Left((errorMsg, _)) => printError(errorMsg)
     }
 
-  private def runWatchLoop(path: Path, config: CompilerConfig): IO[Unit] =
+  private def runWatchLoop(path: Path, config: CompilerConfig, cache: FrontEndCache): IO[Unit] =
     val singleIteration =
       for
         _ <- FileWatcher.watchForChanges(path)
         _ <- FileWatcher.printChangeDetected()
-        result <- compileDev(path, config)
+        result <- compileDev(path, config, cache)
         _ <- result match
           case Right(_) => printSuccess()
           case Left((errorMsg, _)) => printError(errorMsg)
@@ -45,7 +52,8 @@ object DevLoop:
 
   private def compileDev(
     path:   Path,
-    config: CompilerConfig
+    config: CompilerConfig,
+    cache:  FrontEndCache
   ): IO[Either[(String, Option[CompilerState]), CompilerState]] =
     val moduleName = Compilation.moduleNameFromPath(path)
     val sourcePath = Compilation.sourcePathFromPath(path)
@@ -55,7 +63,9 @@ object DevLoop:
         case Left(error) =>
           IO.pure(Left((s"Error reading file: ${error.getMessage}", None)))
         case Right(content) =>
-          FrontEndApi.compile(content, moduleName, config, Some(sourcePath)).value.map {
+          val key = FrontEndCache.Key(content, moduleName, Some(sourcePath), config)
+          val compile = FrontEndApi.compile(content, moduleName, config, Some(sourcePath)).value
+          cache.getOrCompile(key)(compile).map {
             case Left(error) =>
               Left((ErrorPrinter.prettyPrint(error, Some(SourceInfo(content))), None))
             case Right(state) =>
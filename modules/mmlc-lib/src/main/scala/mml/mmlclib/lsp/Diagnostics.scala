@@ -54,6 +54,9 @@ object Diagnostics:
       case SemanticError.PartialApplicationWithConsuming(fn, _, _) => fn.spanOpt.toList
       case SemanticError.ConditionalOwnershipMismatch(cond, _) => cond.spanOpt.toList
       case SemanticError.BorrowEscapeViaReturn(ref, _) => ref.spanOpt.toList
+      case SemanticError.ViewOutlivesParent(ref, _, _) => ref.spanOpt.toList
+      case SemanticError.ViewOfTemporary(app, _) => app.spanOpt.toList
+      case SemanticError.ViewEscapesParent(view, _, _) => view.spanOpt.toList
 
       case te: TypeError => extractTypeErrorSpans(te)
 
@@ -125,6 +128,9 @@ object Diagnostics:
       case e: SemanticError.PartialApplicationWithConsuming => e.message
       case e: SemanticError.ConditionalOwnershipMismatch => e.message
       case e: SemanticError.BorrowEscapeViaReturn => e.message
+      case e: SemanticError.ViewOutlivesParent => e.message
+      case e: SemanticError.ViewOfTemporary => e.message
+      case e: SemanticError.ViewEscapesParent => e.message
 
       case te: TypeError => formatTypeError(te)
 
@@ -1,7 +1,7 @@
 package mml.mmlclib.lsp
 
 import cats.effect.{IO, Ref}
-import mml.mmlclib.compiler.{Compilation, CompilerConfig, CompilerState}
+import mml.mmlclib.compiler.{Compilation, CompilerConfig, CompilerState, FrontEndCache}
 import org.typelevel.log4cats.Logger
 
 /** State of a single open document. */
@@ -16,6 +16,7 @@ case class DocumentState(
 class DocumentManager(
   config:       CompilerConfig,
   documentsRef: Ref[IO, Map[String, DocumentState]],
+  cache:        FrontEndCache,
   logger:       Logger[IO]
 ):
 
@@ -51,7 +52,7 @@ class DocumentManager(
     val sourcePath = Compilation.sourcePathFromUri(uri)
     logger.debug(s"Compiling $uri (module=$moduleName)") *>
       Compilation
-        .compileSource(content, moduleName, sourcePath, config)
+        .compileSourceCached(cache, content, moduleName, sourcePath, config)
         .flatMap { state =>
           val errorCount = state.errors.size
           val docState   = DocumentState(uri, content, version, state)
@@ -66,6 +67,7 @@ object DocumentManager:
 
   /** Create a new document manager. */
   def create(config: CompilerConfig, logger: Logger[IO]): IO[DocumentManager] =
-    Ref.of[IO, Map[String, DocumentState]](Map.empty).map { ref =>
-      new DocumentManager(config, ref, logger)
-    }
+    for
+      ref <- Ref.of[IO, Map[String, DocumentState]](Map.empty)
+      cache <- FrontEndCache.create()
+    yield new DocumentManager(config, ref, cache, logger)
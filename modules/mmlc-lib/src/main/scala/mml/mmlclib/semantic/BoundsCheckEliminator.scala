@@ -0,0 +1,368 @@
+package mml.mmlclib.semantic
+
+import mml.mmlclib.ast.*
+import mml.mmlclib.compiler.CompilerState
+
+/** Rewrites checked array accesses (`ar_<T>_get` / `ar_<T>_set`) to their `unsafe_` forms when the
+  * index is provably in range, and records how many checks were removed.
+  *
+  * An access `ar_int_get arr i` is in range when both of these hold where it runs:
+  *
+  *   - `i < length arr`, from a dominating guard: the `then` branch of `i < n` / `n > i`, or the
+  *     `else` branch of `i >= n` / `n <= i`, where `n` is `ar_<T>_len arr`, the size `arr` was
+  *     allocated with, or a parameter known to be at most the length of `arr`.
+  *   - `0 <= i`, from literals, lengths and non-overflowing arithmetic on non-negative values.
+  *
+  * Facts about parameters hold when every call site supplies them. They are solved as a greatest
+  * fixpoint over the module's calls, which is what proves the usual tail-recursive loop
+  * `loop arr (i + 1) n` entered as `loop arr 0 (ar_int_len arr)`. Functions that can be entered
+  * another way (public, never called, or used as a value) get no parameter facts.
+  */
+object BoundsCheckEliminator:
+
+  private val statementParamName = "__stmt"
+
+  /** Stride below which `i + k` cannot overflow when `i` is an array index. */
+  private val MaxStride = 1 << 30
+
+  private val uncheckedAccessors: Map[String, String] =
+    arrayFamilies.flatMap { family =>
+      List("get", "set").map { op =>
+        s"stdlib::bnd::ar_${family.prefix}_$op" -> s"unsafe_ar_${family.prefix}_$op"
+      }
+    }.toMap
+
+  private val arrayPrefixes  = arrayFamilies.map(_.prefix) :+ "str"
+  private val lenFnIds       = arrayPrefixes.map(p => s"stdlib::bnd::ar_${p}_len").toSet
+  private val newFnIds       = arrayPrefixes.map(p => s"stdlib::bnd::ar_${p}_new").toSet
+  private val arrayTypeNames = arrayFamilies.map(_.typeName).toSet + "StringArray"
+  private val intTypeNames   = Set("Int", "Int64")
+
+  private def opId(op: String): String = s"stdlib::bnd::${OpMangling.mangleOp(op, 2)}"
+
+  private val LtId  = opId("<")
+  private val GtId  = opId(">")
+  private val LeId  = opId("<=")
+  private val GeId  = opId(">=")
+  private val AndId = opId("and")
+  private val AddId = opId("+")
+  private val DivId = opId("/")
+  private val RemId = opId("%")
+
+  /** Parameter facts, keyed by parameter id. */
+  private final case class Facts(
+    nonNeg:    Set[String],
+    atMostLen: Set[(String, String)] // (n, arr): n <= length arr
+  ) derives CanEqual
+
+  /** What is known at a program point. Keys are binding ids. */
+  private final case class Ctx(
+    current: Option[String], // the function being walked
+    lets:    Map[String, Term]     = Map.empty, // let-bound id -> initializer
+    below:   Set[(String, String)] = Set.empty, // (i, arr): i < length arr
+    bounded: Set[String]           = Set.empty // i < x for some x
+  )
+
+  /** What a walk saw: checks removed and kept, how user functions are entered, and the assumed
+    * parameter facts that some call site does not supply. Walks of separate terms are combined
+    * with `++`.
+    */
+  private final case class PassResult(
+    removed:     Int                   = 0,
+    kept:        Int                   = 0,
+    called:      Set[String]           = Set.empty,
+    escaped:     Set[String]           = Set.empty,
+    nonNegDrops: Set[String]           = Set.empty,
+    boundDrops:  Set[(String, String)] = Set.empty
+  ):
+    def ++(other: PassResult): PassResult =
+      PassResult(
+        removed     = removed + other.removed,
+        kept        = kept + other.kept,
+        called      = called ++ other.called,
+        escaped     = escaped ++ other.escaped,
+        nonNegDrops = nonNegDrops ++ other.nonNegDrops,
+        boundDrops  = boundDrops ++ other.boundDrops
+      )
+
+  private object PassResult:
+    val empty: PassResult = PassResult()
+
+  def rewriteModule(state: CompilerState): CompilerState =
+    val members = state.module.members
+    val userFns = members.collect {
+      case bnd: Bnd if bnd.id.exists(!_.startsWith("stdlib::")) =>
+        bnd.value.terms match
+          case (lambda: Lambda) :: _ => bnd.id.map(_ -> lambda.params)
+          case _ => None
+    }.flatten.toMap
+    val publicFns = members.collect {
+      case bnd: Bnd if bnd.visibility == Visibility.Public => bnd.id
+    }.flatten.toSet
+
+    val candidates = Facts(
+      nonNeg = userFns.values.flatten.filter(hasType(_, intTypeNames)).flatMap(_.id).toSet,
+      atMostLen = userFns.values.flatMap { params =>
+        for
+          n <- params if hasType(n, intTypeNames)
+          arr <- params if hasType(arr, arrayTypeNames)
+          nId <- n.id
+          arrId <- arr.id
+        yield nId -> arrId
+      }.toSet
+    )
+
+    @annotation.tailrec
+    def solve(assumed: Facts): (PassResult, List[Member]) =
+      val walked    = ParallelMembers.map(members)(Pass(assumed, userFns).member)
+      val rewritten = walked.map(_._1)
+      val pass      = walked.foldLeft(PassResult.empty)(_ ++ _._2)
+      val entries   = publicFns ++ pass.escaped ++ userFns.keySet.diff(pass.called)
+      val entryParams = entries.flatMap(userFns.get).flatten.flatMap(_.id)
+      val next = Facts(
+        nonNeg = assumed.nonNeg.diff(entryParams).diff(pass.nonNegDrops),
+        atMostLen = assumed.atMostLen
+          .diff(pass.boundDrops)
+          .filterNot((n, arr) => entryParams.contains(n) || entryParams.contains(arr))
+      )
+      if next == assumed then (pass, rewritten) else solve(next)
+
+    val (pass, rewritten) = solve(candidates)
+    val resolvables = rewritten.foldLeft(state.module.resolvables) {
+      case (idx, bnd: Bnd) => idx.updated(bnd)
+      case (idx, _) => idx
+    }
+    state
+      .withModule(state.module.copy(members = rewritten, resolvables = resolvables))
+      .addCounter("semantic", "bounds-checks-removed", pass.removed.toLong)
+      .addCounter("semantic", "bounds-checks-kept", pass.kept.toLong)
+
+  private def hasType(param: FnParam, names: Set[String]): Boolean =
+    param.typeSpec.orElse(param.typeAsc).exists {
+      case TypeRef(_, name, _, _) => names.contains(name)
+      case _ => false
+    }
+
+  /** One walk over the module under a fixed set of parameter assumptions. Each member is walked
+    * on its own, so members can be walked in parallel.
+    */
+  private final class Pass(assumed: Facts, userFns: Map[String, List[FnParam]]):
+
+    def member(m: Member): (Member, PassResult) = m match
+      case bnd: Bnd if bnd.id.exists(!_.startsWith("stdlib::")) =>
+        val (value, result) = expr(bnd.value, Ctx(current = bnd.id))
+        (bnd.copy(value = value), result)
+      case other => (other, PassResult.empty)
+
+    private def expr(e: Expr, ctx: Ctx): (Expr, PassResult) =
+      val (terms, result) = walkAll(e.terms)(term(_, ctx))
+      (e.copy(terms = terms), result)
+
+    private def walkAll[A](items: List[A])(walk: A => (A, PassResult)): (List[A], PassResult) =
+      items.foldRight((List.empty[A], PassResult.empty)) { case (item, (done, acc)) =>
+        val (walked, result) = walk(item)
+        (walked :: done, result ++ acc)
+      }
+
+    private def term(t: Term, ctx: Ctx): (Term, PassResult) = t match
+      case e: Expr => expr(e, ctx)
+      case c: Cond =>
+        val (onTrue, onFalse)      = guardFacts(c.cond, ctx)
+        val (cond, condResult)     = expr(c.cond, ctx)
+        val (ifTrue, trueResult)   = expr(c.ifTrue, onTrue)
+        val (ifFalse, falseResult) = expr(c.ifFalse, onFalse)
+        val walked                 = c.copy(cond = cond, ifTrue = ifTrue, ifFalse = ifFalse)
+        (walked, condResult ++ trueResult ++ falseResult)
+      case app: App => application(app, ctx)
+      case lambda: Lambda =>
+        val (body, result) = expr(lambda.body, ctx)
+        (lambda.copy(body = body), result)
+      case ref: Ref =>
+        val escaped = PassResult(escaped = ref.resolvedId.filter(userFns.contains).toSet)
+        ref.qualifier match
+          case Some(qualifier) =>
+            val (walked, result) = term(qualifier, ctx)
+            (ref.copy(qualifier = Some(walked)), escaped ++ result)
+          case None => (ref, escaped)
+      case group: TermGroup =>
+        val (inner, result) = expr(group.inner, ctx)
+        (group.copy(inner = inner), result)
+      case tuple: Tuple =>
+        val walked = tuple.elements.map(expr(_, ctx))
+        (tuple.copy(elements = walked.map(_._1)), walked.foldLeft(PassResult.empty)(_ ++ _._2))
+      case other => (other, PassResult.empty)
+
+    private def application(app: App, ctx: Ctx): (Term, PassResult) =
+      app.fn match
+        case lambda: Lambda =>
+          // Let-binding or statement sequence: the body sees the bound initializer
+          val bodyCtx = lambda.params match
+            case List(param) if param.name != statementParamName =>
+              param.id.fold(ctx)(id => ctx.copy(lets = ctx.lets + (id -> app.arg)))
+            case _ => ctx
+          val (body, bodyResult) = expr(lambda.body, bodyCtx)
+          val (arg, argResult)   = expr(app.arg, ctx)
+          (app.copy(fn = lambda.copy(body = body), arg = arg), bodyResult ++ argResult)
+        case _ =>
+          val (base, args) = spine(app, Nil)
+          base match
+            case ref: Ref =>
+              val (callee, callResult) = call(ref, args, ctx)
+              val (rebuilt, result)    = rebuild(app, callee, ctx)
+              (rebuilt, callResult ++ result)
+            case _ => rebuild(app, base, ctx)
+
+    private def call(ref: Ref, args: List[Term], ctx: Ctx): (Ref, PassResult) =
+      val entry = ref.resolvedId.flatMap(id => userFns.get(id).map(id -> _)) match
+        case Some((id, params)) if params.size == args.size =>
+          // Self-calls do not count: something else has to enter the function first
+          val called = if ctx.current.contains(id) then Set.empty[String] else Set(id)
+          PassResult(called = called) ++ checkCallSite(params, args, ctx)
+        case Some((id, _)) => PassResult(escaped = Set(id))
+        case None => PassResult.empty
+      ref.resolvedId.flatMap(uncheckedAccessors.get) match
+        case Some(unchecked) if inRange(args, ctx) =>
+          val uncheckedId = s"stdlib::bnd::$unchecked"
+          val unsafeRef = ref.copy(
+            name         = unchecked,
+            resolvedId   = Some(uncheckedId),
+            candidateIds = List(uncheckedId)
+          )
+          (unsafeRef, entry ++ PassResult(removed = 1))
+        case Some(_) => (ref, entry ++ PassResult(kept = 1))
+        case None => (ref, entry)
+
+    /** The assumed facts about `params` that this call site does not supply. */
+    private def checkCallSite(params: List[FnParam], args: List[Term], ctx: Ctx): PassResult =
+      val argById = params.flatMap(_.id).zip(args).toMap
+      val nonNegDrops = argById.collect {
+        case (id, arg) if assumed.nonNeg.contains(id) && !nonNeg(arg, ctx) => id
+      }.toSet
+      val boundDrops = assumed.atMostLen.filter { (n, arr) =>
+        (argById.get(n), argById.get(arr)) match
+          case (Some(nArg), Some(arrArg)) =>
+            !idOf(arrArg, ctx).exists(lenBoundedArrays(nArg, ctx).contains)
+          case _ => false
+      }
+      PassResult(nonNegDrops = nonNegDrops, boundDrops = boundDrops)
+
+    private def rebuild(app: App, base: Ref | Lambda, ctx: Ctx): (App, PassResult) =
+      val (fn, fnResult): (Ref | App | Lambda, PassResult) = app.fn match
+        case inner: App => rebuild(inner, base, ctx)
+        case _: Ref => (base, PassResult.empty)
+        case lambda: Lambda =>
+          val (body, result) = expr(lambda.body, ctx)
+          (lambda.copy(body = body), result)
+      val (arg, argResult) = expr(app.arg, ctx)
+      (app.copy(fn = fn, arg = arg), fnResult ++ argResult)
+
+    private def inRange(args: List[Term], ctx: Ctx): Boolean =
+      args match
+        case arr :: idx :: _ =>
+          (idOf(arr, ctx), idOf(idx, ctx)) match
+            case (Some(arrId), Some(idxId)) =>
+              ctx.below.contains(idxId -> arrId) && nonNeg(idx, ctx)
+            case _ => false
+        case _ => false
+
+    // --- Facts about values ---
+
+    private def nonNeg(t: Term, ctx: Ctx): Boolean =
+      unwrap(t) match
+        case lit: LiteralInt => lit.value >= 0
+        case other =>
+          stdlibCall(other) match
+            case Some((id, List(_))) if lenFnIds.contains(id) => true
+            case Some((id, List(a, b))) if id == AddId =>
+              sumNonNeg(a, b, ctx) || sumNonNeg(b, a, ctx)
+            case Some((id, List(a, b))) if id == DivId => nonNeg(a, ctx) && nonNeg(b, ctx)
+            case Some((id, List(a, _))) if id == RemId => nonNeg(a, ctx)
+            case Some(_) => false
+            case None =>
+              idOf(other, ctx).exists { id =>
+                assumed.nonNeg.contains(id) || ctx.lets.get(id).exists(nonNeg(_, ctx))
+              }
+
+    /** `x + k` stays non-negative for a literal `k` only if the addition cannot wrap. */
+    private def sumNonNeg(x: Term, k: Term, ctx: Ctx): Boolean =
+      unwrap(k) match
+        case lit: LiteralInt if lit.value >= 0 && nonNeg(x, ctx) =>
+          lit.value == 0 || idOf(x, ctx).exists { id =>
+            (lit.value == 1 && ctx.bounded.contains(id)) ||
+            (lit.value <= MaxStride && ctx.below.exists(_._1 == id))
+          }
+        case _ => false
+
+    /** Ids of the arrays whose length is at least the value of `t`. */
+    private def lenBoundedArrays(t: Term, ctx: Ctx): Set[String] =
+      stdlibCall(unwrap(t)) match
+        case Some((id, List(arr))) if lenFnIds.contains(id) => idOf(arr, ctx).toSet
+        case Some(_) => Set.empty
+        case None =>
+          idOf(t, ctx) match
+            case Some(id) =>
+              val fromParams = assumed.atMostLen.collect { case (n, arr) if n == id => arr }
+              val fromLet    = ctx.lets.get(id).map(lenBoundedArrays(_, ctx)).getOrElse(Set.empty)
+              // `ar_<T>_new n` has length n, or 0 when n <= 0
+              val allocated = ctx.lets.collect {
+                case (arrId, init) if allocatedWith(init, id, ctx) => arrId
+              }
+              fromParams ++ fromLet ++ allocated
+            case None => Set.empty
+
+    private def allocatedWith(init: Term, sizeId: String, ctx: Ctx): Boolean =
+      stdlibCall(unwrap(init)) match
+        case Some((id, List(size))) => newFnIds.contains(id) && idOf(size, ctx).contains(sizeId)
+        case _ => false
+
+    // --- Facts from guards ---
+
+    /** Contexts for the `then` and `else` branches of a condition. */
+    private def guardFacts(cond: Term, ctx: Ctx): (Ctx, Ctx) =
+      stdlibCall(unwrap(cond)) match
+        case Some((id, List(a, b))) if id == LtId => (less(a, b, ctx), ctx)
+        case Some((id, List(a, b))) if id == GtId => (less(b, a, ctx), ctx)
+        case Some((id, List(a, b))) if id == GeId => (ctx, less(a, b, ctx))
+        case Some((id, List(a, b))) if id == LeId => (ctx, less(b, a, ctx))
+        case Some((id, List(a, b))) if id == AndId =>
+          val (afterA, _) = guardFacts(a, ctx)
+          val (afterB, _) = guardFacts(b, afterA)
+          (afterB, ctx)
+        case _ => (ctx, ctx)
+
+    private def less(a: Term, b: Term, ctx: Ctx): Ctx =
+      idOf(a, ctx) match
+        case Some(id) =>
+          ctx.copy(
+            bounded = ctx.bounded + id,
+            below   = ctx.below ++ lenBoundedArrays(b, ctx).map(id -> _)
+          )
+        case None => ctx
+
+    /** The binding a term names, following `let k = i` aliases. */
+    private def idOf(t: Term, ctx: Ctx): Option[String] =
+      unwrap(t) match
+        case ref: Ref if ref.qualifier.isEmpty =>
+          ref.resolvedId.map { id =>
+            ctx.lets.get(id).flatMap(idOf(_, ctx)).getOrElse(id)
+          }
+        case _ => None
+
+  private def unwrap(t: Term): Term = t match
+    case Expr(_, List(single), _, _) => unwrap(single)
+    case TermGroup(_, inner, _) => unwrap(inner)
+    case other => other
+
+  /** Callee id and arguments of a saturated call to a stdlib function. */
+  private def stdlibCall(t: Term): Option[(String, List[Term])] = t match
+    case app: App =>
+      spine(app, Nil) match
+        case (ref: Ref, args) => ref.resolvedId.filter(_.startsWith("stdlib::")).map(_ -> args)
+        case _ => None
+    case _ => None
+
+  private def spine(t: Ref | App | Lambda, args: List[Term]): (Ref | Lambda, List[Term]) =
+    t match
+      case ref: Ref => (ref, args)
+      case lambda: Lambda => (lambda, args)
+      case App(_, inner, arg, _, _) => spine(inner, arg :: args)
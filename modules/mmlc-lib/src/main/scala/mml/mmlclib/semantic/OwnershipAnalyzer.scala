@@ -1,7 +1,7 @@
 package mml.mmlclib.semantic
 
 import mml.mmlclib.ast.*
-import mml.mmlclib.compiler.CompilerState
+import mml.mmlclib.compiler.{CompilerState, Counter}
 
 import scala.annotation.tailrec
 
@@ -31,7 +31,8 @@ case class OwnershipScope(
   tempCounter:            Int                         = 0,
   insideTempWrapper:      Boolean                     = false,
   consumedVia:            Map[String, (Ref, FnParam)] = Map.empty,
-  skipConsumingOwnership: Boolean                     = false
+  skipConsumingOwnership: Boolean                     = false,
+  viewParents:            Map[String, String]         = Map.empty
 ):
 
   def nextTemp: (String, OwnershipScope) =
@@ -64,6 +65,17 @@ case class OwnershipScope(
   def withBorrowed(name: String): OwnershipScope =
     copy(bindings = bindings + (name -> BindingInfo(OwnershipState.Borrowed)))
 
+  /** Record `view` as a borrowed slice of `parent`, following views of views to the owner. */
+  def withView(view: String, parent: String): OwnershipScope =
+    val root = viewParents.getOrElse(parent, parent)
+    copy(
+      bindings    = bindings + (view -> BindingInfo(OwnershipState.Borrowed)),
+      viewParents = viewParents + (view -> root)
+    )
+
+  def viewsOf(parent: String): List[String] =
+    viewParents.collect { case (view, `parent`) => view }.toList
+
   def withLiteral(name: String): OwnershipScope =
     copy(bindings = bindings + (name -> BindingInfo(OwnershipState.Literal)))
 
@@ -110,6 +122,7 @@ object OwnershipAnalyzer:
   private val syntheticSource = SourceOrigin.Synth
 
   private val UnitTypeId = "stdlib::typedef::Unit"
+  private val ViewFnIds = Set("stdlib::bnd::substring_view", "stdlib::bnd::mapped_as_string")
   private val BoolTypeId = "stdlib::typedef::Bool"
 
   private def unitTypeRef(source: SourceOrigin): TypeRef =
@@ -625,6 +638,33 @@ object OwnershipAnalyzer:
         case _ => List.empty
     expr.terms.lastOption.map(termReturned).getOrElse(List.empty)
 
+  /** Views that flow out through the returned expression, each with the root binding it borrows.
+    * Follows let chains, so a view bound inside the returned expression is found as well.
+    */
+  private def returnedViews(expr: Expr, scope: OwnershipScope): List[(Term, String)] =
+    def inExpr(expr: Expr, views: Map[String, String]): List[(Term, String)] =
+      expr.terms.lastOption.map(inTerm(_, views)).getOrElse(Nil)
+
+    def inTerm(term: Term, views: Map[String, String]): List[(Term, String)] =
+      term match
+        case ref: Ref if ref.qualifier.isEmpty && views.contains(ref.name) =>
+          List(ref -> views(ref.name))
+        case App(_, Lambda(_, params, body, _, _, _, _), arg, _, _) =>
+          val bound = params.headOption.fold(views): param =>
+            arg.terms.headOption.map(unwrapTerm).flatMap(viewParentRef) match
+              case Some(parent) =>
+                views + (param.name -> views.getOrElse(parent.name, parent.name))
+              case None => views - param.name
+          inExpr(body, bound)
+        case app: App =>
+          viewParentRef(app).map(p => app -> views.getOrElse(p.name, p.name)).toList
+        case Cond(_, _, ifTrue, ifFalse, _, _) => inExpr(ifTrue, views) ++ inExpr(ifFalse, views)
+        case TermGroup(_, inner, _) => inExpr(inner, views)
+        case inner: Expr => inExpr(inner, views)
+        case _ => Nil
+
+    inExpr(expr, scope.viewParents)
+
   /** Check if a binding name is referenced anywhere in an expression */
   private def containsRefInExpr(name: String, expr: Expr): Boolean =
     expr.terms.exists(containsRef(name, _))
@@ -646,6 +686,120 @@ object OwnershipAnalyzer:
       case expr: Expr => containsRefInExpr(name, expr)
       case _ => false
 
+  /** Number of references to a binding name in a term, honouring shadowing */
+  private def countRefs(name: String, term: Term): Int =
+    term match
+      case ref: Ref =>
+        (if ref.name == name then 1 else 0) + ref.qualifier.fold(0)(countRefs(name, _))
+      case App(_, fn, arg, _, _) => countRefs(name, fn) + countRefs(name, arg)
+      case Cond(_, cond, ifTrue, ifFalse, _, _) =>
+        countRefs(name, cond) + countRefs(name, ifTrue) + countRefs(name, ifFalse)
+      case TermGroup(_, inner, _) => countRefs(name, inner)
+      case Tuple(_, elements, _, _) => elements.foldLeft(0)(_ + countRefs(name, _))
+      case Lambda(_, params, body, _, _, _, _) =>
+        if params.exists(_.name == name) then 0 else countRefs(name, body)
+      case expr: Expr => expr.terms.foldLeft(0)(_ + countRefs(name, _))
+      case _ => 0
+
+  /** True for `__clone_T` functions (stdlib or generated) and the prelude's `clone_T` wrappers */
+  private def isCloneFn(ref: Ref, resolvables: ResolvablesIndex): Boolean =
+    def nativeClone(term: Term): Boolean = term match
+      case native: NativeImpl => native.nativeSymbol.exists(_.startsWith("__clone_"))
+      case lambda: Lambda => lambda.body.terms.exists(nativeClone)
+      case expr:   Expr => expr.terms.exists(nativeClone)
+      case _ => false
+    ref.resolvedId.flatMap(resolvables.lookup).exists:
+      case bnd: Bnd => bnd.name.startsWith("__clone_") || nativeClone(bnd.value)
+      case _ => false
+
+  /** Turn a clone of an owned binding into a move when the clone is the binding's last use.
+    *
+    * `f (__clone_T x)` copies `x` only for the copy to be freed after the call (or consumed by
+    * `f`) while `x` itself is freed at scope end. If nothing refers to `x` after the clone,
+    * passing `x` directly does the same with no copy: a consuming `f` moves it, a borrowing `f`
+    * leaves it to the scope-end free. The walk follows evaluation order along the let/statement
+    * chain, so earlier reads of `x` do not matter; a clone is rewritten only when no other
+    * reference to `x` is in the same call or anywhere after it. Each branch of a conditional is
+    * walked with what follows the conditional as its continuation, so one branch can move `x`
+    * while the other keeps it (the conditional then frees `x` in that branch). A clone inside a
+    * lambda is left alone, and so is `let y = __clone_T x`, where `y` would become a borrow.
+    */
+  private def elideLastUseClone(name: String, body: Expr, resolvables: ResolvablesIndex): Expr =
+    def refers(term: Term): Boolean = countRefs(name, term) > 0
+
+    def cloneOfName(arg: Expr): Option[Ref] =
+      arg.terms match
+        case List(term) =>
+          unwrapTerm(term) match
+            case App(_, cloneFn: Ref, cloneArg, _, _) if isCloneFn(cloneFn, resolvables) =>
+              cloneArg.terms.map(unwrapTerm) match
+                case List(ref: Ref) if ref.name == name && ref.qualifier.isEmpty => Some(ref)
+                case _ => None
+            case _ => None
+        case _ => None
+
+    // `usedAfter`: `name` is referenced after `expr` has been evaluated.
+    def inExpr(expr: Expr, usedAfter: Boolean): Expr =
+      val (terms, _) = expr.terms.foldRight((List.empty[Term], usedAfter)) {
+        case (term, (rest, after)) => (inTerm(term, after) :: rest, after || refers(term))
+      }
+      expr.copy(terms = terms)
+
+    // Arguments of one call; a clone among them is a last use unless `blocked`.
+    def inCall(app: App, blocked: Boolean): App =
+      val newArg = cloneOfName(app.arg) match
+        case Some(ref) if !blocked => app.arg.copy(terms = List(ref))
+        case _ => inExpr(app.arg, blocked)
+      val newFn = app.fn match
+        case inner: App => inCall(inner, blocked)
+        case other => other
+      app.copy(fn = newFn, arg = newArg)
+
+    def inTerm(term: Term, usedAfter: Boolean): Term =
+      term match
+        case app @ App(_, let: Lambda, arg, _, _) =>
+          // A let or statement: `arg` runs first, then the body.
+          if let.params.exists(_.name == name) then app.copy(arg = inExpr(arg, usedAfter))
+          else
+            app.copy(
+              fn  = let.copy(body = inExpr(let.body, usedAfter)),
+              arg = inExpr(arg, usedAfter || refers(let.body))
+            )
+        case app: App => inCall(app, usedAfter || countRefs(name, app) > 1)
+        case cond: Cond =>
+          cond.copy(
+            cond    = inExpr(cond.cond, usedAfter || refers(cond.ifTrue) || refers(cond.ifFalse)),
+            ifTrue  = inExpr(cond.ifTrue, usedAfter),
+            ifFalse = inExpr(cond.ifFalse, usedAfter)
+          )
+        case group: TermGroup => group.copy(inner = inExpr(group.inner, usedAfter))
+        case expr:  Expr => inExpr(expr, usedAfter)
+        case other => other
+
+    if refers(body) then inExpr(body, usedAfter = false) else body
+
+  /** Clone calls in a term, as (all, written in the source) */
+  private def cloneCalls(term: Term, resolvables: ResolvablesIndex): (Int, Int) =
+    def sum(terms: Iterable[Term]): (Int, Int) =
+      terms.foldLeft((0, 0)) { (acc, t) =>
+        val (all, user) = cloneCalls(t, resolvables)
+        (acc._1 + all, acc._2 + user)
+      }
+    term match
+      case app @ App(_, fn, arg, _, _) =>
+        val (all, user) = sum(List(fn, arg))
+        fn match
+          case ref: Ref if isCloneFn(ref, resolvables) =>
+            val written = if app.source == SourceOrigin.Synth then 0 else 1
+            (all + 1, user + written)
+          case _ => (all, user)
+      case Cond(_, cond, ifTrue, ifFalse, _, _) => sum(List(cond, ifTrue, ifFalse))
+      case TermGroup(_, inner, _) => cloneCalls(inner, resolvables)
+      case Tuple(_, elements, _, _) => sum(elements.toList)
+      case lambda: Lambda => cloneCalls(lambda.body, resolvables)
+      case expr:   Expr => sum(expr.terms)
+      case _ => (0, 0)
+
   /** Get the consuming parameter for a given argument position in an App chain. Returns the FnParam
     * if it's consuming, None otherwise.
     */
@@ -672,6 +826,19 @@ object OwnershipAnalyzer:
           // depth=0 means we're applying to first param, depth=1 to second, etc.
           lambda.params.lift(depth).filter(_.consuming)
 
+  /** The parent argument of a view call (`substring_view parent ...`, `mapped_as_string parent`). */
+  private def viewParentArg(term: Term): Option[Expr] =
+    term match
+      case app: App if getBaseFn(app.fn).flatMap(_.resolvedId).exists(ViewFnIds.contains) =>
+        collectArgsAndBase(app.fn, List((app.arg, app.source, None, None)))._2.headOption
+          .map(_._1)
+      case _ => None
+
+  /** The parent of a view call when it is a plain binding. */
+  private def viewParentRef(term: Term): Option[Ref] =
+    viewParentArg(term).flatMap(_.terms.headOption.map(unwrapTerm)).collect:
+      case parent: Ref if parent.qualifier.isEmpty => parent
+
   @tailrec
   private def unwrapTerm(term: Term): Term = term match
     case TermGroup(_, inner, _) if inner.terms.size == 1 => unwrapTerm(inner.terms.head)
@@ -710,10 +877,14 @@ object OwnershipAnalyzer:
                 // Borrowed refs cannot satisfy consuming params.
                 if scope.insideTempWrapper then (scope, Nil)
                 else
-                  (
-                    scope,
-                    List(SemanticError.ConsumingParamNotLastUse(consumingParam, ref, PhaseName))
-                  )
+                  scope.viewParents.get(ref.name) match
+                    case Some(parent) =>
+                      (scope, List(SemanticError.ViewEscapesParent(ref, parent, PhaseName)))
+                    case None =>
+                      (
+                        scope,
+                        List(SemanticError.ConsumingParamNotLastUse(consumingParam, ref, PhaseName))
+                      )
               case Some(OwnershipState.Global) =>
                 // Accepted; wrapper ensures clone
                 (scope, Nil)
@@ -802,6 +973,16 @@ object OwnershipAnalyzer:
             SemanticError.ConsumingParamNotLastUse(param, ref, PhaseName)
       else Nil
 
+    // A substring view shares its parent's bytes, so the parent may not move while it is used
+    val viewErrors = newlyMoved.toList.flatMap: name =>
+      scope
+        .viewsOf(name)
+        .filter(containsRefInExpr(_, body))
+        .flatMap: view =>
+          argResult.scope.consumedVia
+            .get(name)
+            .map((ref, _) => SemanticError.ViewOutlivesParent(ref, view, PhaseName))
+
     // Track bindings that already belonged to the outer scope so we don't free them
     // inside this CPS wrapper. Only bindings created in this let should be freed here.
     val inheritedOwned: Set[String] =
@@ -847,13 +1028,24 @@ object OwnershipAnalyzer:
             argResult.scope
               .withMoved(ref.name, ref.source)
               .withOwned(param.name, srcInfo.bindingTpe, param.id)
+          case Some(term) if viewParentArg(term).isDefined =>
+            viewParentRef(term) match
+              case Some(parent) => argResult.scope.withView(param.name, parent.name)
+              case None => argResult.scope.withBorrowed(param.name)
           case _ =>
             argResult.scope.withBorrowed(param.name)
         (newScope, None)
       case None =>
         (argResult.scope, None)
 
-    val bodyResult = analyzeExpr(body, bodyScope)
+    val ownedParam = params.headOption.filter { p =>
+      witnessOpt.isEmpty && !scope.insideTempWrapper &&
+      bodyScope.getState(p.name).contains(OwnershipState.Owned)
+    }
+    val liveBody =
+      ownedParam.fold(body)(p => elideLastUseClone(p.name, body, scope.resolvables))
+
+    val bodyResult = analyzeExpr(liveBody, bodyScope)
     val escaping   = returnedOwnedNames(bodyResult.expr, bodyResult.scope)
 
     // Free all owned bindings at terminal body
@@ -868,6 +1060,12 @@ object OwnershipAnalyzer:
           getTypeName(tpe).exists(isHeapType(_, scope.resolvables))
         case _ => false
 
+    // A view that flows out of this let would outlive a parent freed at its end
+    val freedNames = bindingsToFree.map(_._1).toSet
+    val viewEscapeErrors = returnedViews(liveBody, bodyScope).collect:
+      case (view, parent) if freedNames.contains(parent) =>
+        SemanticError.ViewEscapesParent(view, parent, PhaseName)
+
     val bodyWithTerminalFrees =
       if bindingsToFree.isEmpty then bodyResult.expr
       else
@@ -929,7 +1127,8 @@ object OwnershipAnalyzer:
     TermResult(
       returnScope,
       finalTerm,
-      errors = argResult.errors ++ bodyResult.errors ++ lastUseErrors
+      errors =
+        argResult.errors ++ bodyResult.errors ++ lastUseErrors ++ viewErrors ++ viewEscapeErrors
     )
 
   /** Collect all args and base function from a curried App chain */
@@ -987,23 +1186,50 @@ object OwnershipAnalyzer:
 
     val allocatingArgs = argsWithAlloc.filter(_._5.isDefined)
 
-    if allocatingArgs.isEmpty || scope.insideTempWrapper then
-      // No allocating args - proceed with normal analysis
-      val argResult                 = analyzeExpr(arg, scope)
-      val (scopeAfterArg, fnErrors) = handleConsumingParam(fn, arg, argResult.scope)
-      val fnResult                  = analyzeTerm(fn, scopeAfterArg)
-      TermResult(
-        fnResult.scope,
-        App(
-          span,
-          fnResult.term.asInstanceOf[Ref | App | Lambda],
-          argResult.expr,
-          typeAsc,
-          typeSpec
-        ),
-        errors = argResult.errors ++ fnResult.errors ++ fnErrors
-      )
-    else analyzeAllocatingApp(baseFn, argsWithAlloc, typeSpec, scope)
+    // A view of a temporary would dangle once the temporary is freed after the call
+    val viewOfTempErrors =
+      if getBaseFn(baseFn).flatMap(_.resolvedId).exists(ViewFnIds.contains) &&
+        argsWithAlloc.headOption.exists(_._5.isDefined)
+      then List(SemanticError.ViewOfTemporary(App(span, fn, arg, typeAsc, typeSpec), PhaseName))
+      else Nil
+
+    // A consuming param (a struct field, for a constructor) would own and free the view.
+    // View bindings are caught by handleConsumingParam; this covers inline view calls. The
+    // normal path reaches earlier args through the fn chain, so only this App's arg is checked.
+    val viewConsumedErrors =
+      if scope.insideTempWrapper then Nil
+      else
+        val checkedArgs =
+          if allocatingArgs.isEmpty then allArgsWithMeta.zipWithIndex.takeRight(1)
+          else allArgsWithMeta.zipWithIndex
+        checkedArgs.flatMap { case ((argExpr, _, _, _), idx) =>
+          if !baseFnParams.lift(idx).exists(_.consuming) then Nil
+          else
+            argExpr.terms.headOption.map(unwrapTerm).toList.flatMap: term =>
+              viewParentRef(term).map: parent =>
+                val root = scope.viewParents.getOrElse(parent.name, parent.name)
+                SemanticError.ViewEscapesParent(term, root, PhaseName)
+        }
+
+    val result =
+      if allocatingArgs.isEmpty || scope.insideTempWrapper then
+        // No allocating args - proceed with normal analysis
+        val argResult                 = analyzeExpr(arg, scope)
+        val (scopeAfterArg, fnErrors) = handleConsumingParam(fn, arg, argResult.scope)
+        val fnResult                  = analyzeTerm(fn, scopeAfterArg)
+        TermResult(
+          fnResult.scope,
+          App(
+            span,
+            fnResult.term.asInstanceOf[Ref | App | Lambda],
+            argResult.expr,
+            typeAsc,
+            typeSpec
+          ),
+          errors = argResult.errors ++ fnResult.errors ++ fnErrors
+        )
+      else analyzeAllocatingApp(baseFn, argsWithAlloc, typeSpec, scope)
+    result.copy(errors = viewOfTempErrors ++ viewConsumedErrors ++ result.errors)
 
   /** Handle App with allocating args: create temp bindings and explicit free calls */
   private def analyzeAllocatingApp(
@@ -1253,7 +1479,11 @@ object OwnershipAnalyzer:
       else if p.consuming then s
       else s.withBorrowed(p.name)
 
-    val bodyResult = analyzeExpr(body, paramScope)
+    val liveBody = params
+      .filter(p => p.consuming && !scope.skipConsumingOwnership)
+      .foldLeft(body)((b, p) => elideLastUseClone(p.name, b, scope.resolvables))
+
+    val bodyResult = analyzeExpr(liveBody, paramScope)
 
     val returnType   = typeAsc.orElse(typeSpec)
     val promotedBody = promoteStaticBranchesInReturn(bodyResult.expr, returnType, paramScope)
@@ -1287,10 +1517,16 @@ object OwnershipAnalyzer:
       .getOrElse(Nil)
       .map(ref => SemanticError.BorrowEscapeViaReturn(ref, PhaseName))
 
+    // The caller cannot tell which binding a returned view borrows, so it could not keep the
+    // parent alive; views of locals are already reported by the let that frees them
+    val viewReturnErrors = returnedViews(liveBody, paramScope)
+      .map((view, parent) => SemanticError.ViewEscapesParent(view, parent, PhaseName))
+      .filterNot(bodyResult.errors.contains)
+
     TermResult(
       scope,
       Lambda(span, params, finalBody, captures, typeSpec, typeAsc, meta),
-      errors = bodyResult.errors ++ borrowEscapeErrors
+      errors = bodyResult.errors ++ borrowEscapeErrors ++ viewReturnErrors
     )
 
   /** Analyze a tuple expression */
@@ -1441,12 +1677,26 @@ object OwnershipAnalyzer:
         bnd.name -> BindingInfo(OwnershipState.Global, bnd.typeSpec, bnd.id)
     }.toMap
 
-    val (newMembersRev, allErrorsRev) =
-      module.members.foldLeft((List.empty[Member], List.empty[SemanticError])):
-        case ((membersAcc, errorsAcc), member) =>
-          val (newMember, errors) =
-            analyzeMember(member, module.name, module.resolvables, returningOwned, globals)
-          (newMember :: membersAcc, errors.reverse_:::(errorsAcc))
+    val analyzed = ParallelMembers.map(module.members) { member =>
+      analyzeMember(member, module.name, module.resolvables, returningOwned, globals)
+    }
+
+    // Clones left after analysis, per function, and user-written ones that became moves
+    val cloneStats = module.members.zip(analyzed).collect {
+      case (before: Bnd, (after: Bnd, _)) =>
+        val (_, writtenBefore)   = cloneCalls(before.value, module.resolvables)
+        val (total, writtenLeft) = cloneCalls(after.value, module.resolvables)
+        (after.name, total, writtenBefore - writtenLeft)
+    }
+    val cloneCounters =
+      Counter("semantic", "clones-elided", cloneStats.map(_._3.toLong).sum) ::
+        Counter("semantic", "clones-remaining", cloneStats.map(_._2.toLong).sum) ::
+        cloneStats.collect {
+          case (name, total, _) if total > 0 => Counter("semantic", s"clones:$name", total.toLong)
+        }
 
-    val newModule = module.copy(members = newMembersRev.reverse)
-    state.withModule(newModule).addErrors(allErrorsRev.reverse)
+    val newModule = module.copy(members = analyzed.map(_._1))
+    state
+      .withModule(newModule)
+      .addErrors(analyzed.flatMap(_._2))
+      .addCounters(cloneCounters)
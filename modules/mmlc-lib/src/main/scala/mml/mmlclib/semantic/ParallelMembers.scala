@@ -0,0 +1,34 @@
+package mml.mmlclib.semantic
+
+import mml.mmlclib.ast.Member
+
+import java.util.stream.Collectors
+import scala.jdk.CollectionConverters.*
+
+/** Runs a per-member step of a semantic phase on the common fork-join pool.
+  *
+  * Only for steps that read the module and return a new member (plus errors) without depending on
+  * the results for other members. The result keeps the order of `members`, so merging it is the
+  * same as after a sequential `map` and the output does not depend on scheduling.
+  *
+  * Used by RefResolver, Simplifier, TailRecursionDetector, OwnershipAnalyzer and
+  * BoundsCheckEliminator. TypeChecker is still sequential because it threads the resolvables
+  * updated by one member into the next, and so is codegen, which threads register and metadata
+  * counters through `CodeGenState`; neither has a dependency-ordered or per-function parallel
+  * path. The speedup has not been measured yet: `make bench-compile-throughput` in `benchmark/`
+  * reports the per-stage effect.
+  */
+object ParallelMembers:
+
+  /** Below this many members, the fork-join hand-off costs more than it saves. */
+  private val threshold = 64
+
+  def map[A](members: List[Member])(f: Member => A): List[A] =
+    if members.sizeIs < threshold then members.map(f)
+    else
+      new java.util.ArrayList[Member](members.asJava)
+        .parallelStream()
+        .map[A](member => f(member))
+        .collect(Collectors.toList[A]())
+        .asScala
+        .toList
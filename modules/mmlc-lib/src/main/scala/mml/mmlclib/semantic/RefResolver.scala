@@ -10,17 +10,17 @@ object RefResolver:
 
   /** Resolve all references in a module, accumulating errors in the state. */
   def rewriteModule(state: CompilerState): CompilerState =
-    val (errors, members) =
-      state.module.members.foldLeft((List.empty[SemanticError], List.empty[Member])) {
-        case ((accErrors, accMembers), member) =>
-          resolveMember(member, state.module) match
-            case Left(errs) =>
-              // Important: Use the rewritten member with InvalidExpression nodes, not the original
-              val rewrittenMember = rewriteMemberWithInvalidExpressions(member, state.module)
-              (accErrors ++ errs, accMembers :+ rewrittenMember)
-            case Right(updated) => (accErrors, accMembers :+ updated)
-      }
-    state.addErrors(errors).withModule(state.module.copy(members = members))
+    // Members resolve against the module as it was before the phase, so they are independent
+    val resolved = ParallelMembers.map(state.module.members) { member =>
+      resolveMember(member, state.module) match
+        case Left(errs) =>
+          // Important: Use the rewritten member with InvalidExpression nodes, not the original
+          (errs, rewriteMemberWithInvalidExpressions(member, state.module))
+        case Right(updated) => (Nil, updated)
+    }
+    state
+      .addErrors(resolved.flatMap(_._1))
+      .withModule(state.module.copy(members = resolved.map(_._2)))
 
   /** Rewrite a member to use InvalidExpression nodes for undefined references */
   private def rewriteMemberWithInvalidExpressions(member: Member, module: Module): Member =
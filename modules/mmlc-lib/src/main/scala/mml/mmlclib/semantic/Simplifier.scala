@@ -5,6 +5,16 @@ import mml.mmlclib.ast.*
 import mml.mmlclib.compiler.CompilerState
 
 object Simplifier:
+
+  /** Resolved id of the stdlib `++` operator. */
+  private val ConcatOpId = s"stdlib::bnd::${OpMangling.mangleOp("++", 2)}"
+
+  /** `++` chains with at least this many operands are lowered to a single string builder. */
+  private val MinConcatChain = 3
+
+  /** Bytes reserved for each non-literal operand when pre-sizing the builder. */
+  private val OperandSizeHint = 16
+
   def rewriteModule(module: Module): Either[List[SemanticError], Module] =
     val (updatedMembers, updatedResolvables) = module.members.foldLeft(
       (List.empty[Member], module.resolvables)
@@ -20,14 +30,10 @@ object Simplifier:
       .asRight[List[SemanticError]]
 
   def rewriteModule(state: CompilerState): CompilerState =
-    val (updatedMembers, updatedResolvables) = state.module.members.foldLeft(
-      (List.empty[Member], state.module.resolvables)
-    ) { case ((accMembers, resolvables), member) =>
-      simplifyMember(member) match
-        case updatedBnd: Bnd =>
-          (accMembers :+ updatedBnd, resolvables.updated(updatedBnd))
-        case other =>
-          (accMembers :+ other, resolvables)
+    val updatedMembers = ParallelMembers.map(state.module.members)(simplifyMember)
+    val updatedResolvables = updatedMembers.foldLeft(state.module.resolvables) {
+      case (resolvables, updatedBnd: Bnd) => resolvables.updated(updatedBnd)
+      case (resolvables, _) => resolvables
     }
     state.withModule(state.module.copy(members = updatedMembers, resolvables = updatedResolvables))
 
@@ -59,6 +65,7 @@ object Simplifier:
     *   - For an Expr: simplify its contents, then unwrap if only one term remains.
     *   - For a GroupTerm: simplify its inner expression and remove the group wrapper.
     *   - For AppN: simplify arguments
+    *   - For a chain of 3+ `++`: lower it to one string builder (see `lowerConcatChain`)
     *   - For Cond: simplify branches using simplifyTopLevelExpr.
     *   - Other terms are returned unchanged.
     */
@@ -89,6 +96,9 @@ object Simplifier:
           }
         else finalTerm
 
+      case app: App if concatOperands(app).sizeIs >= MinConcatChain =>
+        lowerConcatChain(app.source, concatOperands(app))
+
       case app: App =>
         // Simplify the function and argument (simplifyExpr calls simplifyTerm)
         val simplifiedArg = simplifyExpr(app.arg) // Use simplifyExpr for args
@@ -122,3 +132,55 @@ object Simplifier:
     } // End of term match
     result // Return the result of the match
   } // End of simplifyTerm function
+
+  /** Flatten a `++` application into its operands, looking through groups and single-term
+    * expressions so that `a ++ (b ++ c)` and `(a ++ b) ++ c` yield the same list. Returns Nil when
+    * the term is not a stdlib `++` application. Runs before the operands are simplified, so a chain
+    * is always lowered from its outermost `++`.
+    */
+  private def concatOperands(term: Term): List[Expr] =
+    def operandsOf(expr: Expr): List[Expr] =
+      expr.terms match
+        case (inner: Expr) :: Nil if inner.typeAsc.isEmpty => operandsOf(inner)
+        case (group: TermGroup) :: Nil if group.typeAsc.isEmpty => operandsOf(group.inner)
+        case single :: Nil =>
+          concatOperands(single) match
+            case Nil => List(expr)
+            case operands => operands
+        case _ => List(expr)
+
+    term match
+      case App(_, App(_, ref: Ref, lhs, _, _), rhs, _, _) if ref.resolvedId.contains(ConcatOpId) =>
+        operandsOf(lhs) ++ operandsOf(rhs)
+      case _ => Nil
+
+  /** Lower `a ++ b ++ ... ++ z` to
+    * `string_builder_finalize (string_builder_append (... (string_builder_new n) a ...) z)`.
+    *
+    * Nested `concat` calls copy the growing prefix once per operand; the builder appends each
+    * operand once and hands its buffer to the result. `n` counts literal operands exactly and
+    * reserves `OperandSizeHint` bytes for every other operand, so typical log lines are built
+    * without regrowing. Operands are still evaluated once each, left to right.
+    */
+  private def lowerConcatChain(source: SourceOrigin, operands: List[Expr]): Term =
+    def stdlibRef(name: String): Ref =
+      Ref(SourceOrigin.Synth, name, resolvedId = Some(s"stdlib::bnd::$name"))
+
+    val capacity = operands.map { operand =>
+      operand.terms match
+        case (lit: LiteralString) :: Nil => lit.value.getBytes("UTF-8").length
+        case _ => OperandSizeHint
+    }.sum
+    val intType = TypeRef(SourceOrigin.Synth, "Int", Some("stdlib::typealias::Int"), Nil)
+    val capacityLit =
+      Expr(SourceOrigin.Synth, List(LiteralInt(SourceOrigin.Synth, capacity, Some(intType))))
+
+    val builder: Term = App(source, stdlibRef("string_builder_new"), capacityLit)
+    val appended = operands.foldLeft(builder) { (sb, operand) =>
+      App(
+        source,
+        App(source, stdlibRef("string_builder_append"), Expr(source, List(sb))),
+        simplifyExpr(operand)
+      )
+    }
+    App(source, stdlibRef("string_builder_finalize"), Expr(source, List(appended)))
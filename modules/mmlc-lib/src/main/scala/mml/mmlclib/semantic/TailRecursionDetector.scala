@@ -8,15 +8,15 @@ object TailRecursionDetector:
   def rewriteModule(state: CompilerState): CompilerState =
     if state.config.noTco then state
     else
-      val (updatedMembers, updatedResolvables) = state.module.members.foldLeft(
-        (List.empty[Member], state.module.resolvables)
-      ) { case ((accMembers, resolvables), member) =>
-        rewriteMember(member) match
-          case updatedBnd: Bnd if updatedBnd ne member.asInstanceOf[AnyRef] =>
-            (accMembers :+ updatedBnd, resolvables.updated(updatedBnd))
-          case other =>
-            (accMembers :+ other, resolvables)
-      }
+      val members        = state.module.members
+      val updatedMembers = ParallelMembers.map(members)(rewriteMember)
+      val updatedResolvables =
+        members.zip(updatedMembers).foldLeft(state.module.resolvables) {
+          case (resolvables, (member, updatedBnd: Bnd))
+              if updatedBnd ne member.asInstanceOf[AnyRef] =>
+            resolvables.updated(updatedBnd)
+          case (resolvables, _) => resolvables
+        }
       state.withModule(
         state.module.copy(members = updatedMembers, resolvables = updatedResolvables)
       )
@@ -953,6 +953,7 @@ object TypeChecker:
           .orElse(module.members.collectFirst { case ts: TypeStruct if ts.name == tr.name => ts })
         resolved match
           case Some(ts: TypeStruct) => Some(ts)
+          case Some(td: TypeDef) if hasOpaqueLayout(td) => None
           case Some(td: TypeDef) =>
             td.typeSpec.collect { case ns: NativeStruct =>
               val fields = ns.fields.map { case (name, t) =>
@@ -963,6 +964,12 @@ object TypeChecker:
           case _ => None
       case _ => None
 
+  /** The runtime stores short Strings inline in the struct, so its `length` and `data` fields
+    * only describe heap strings and are not selectable; `str_len` reads the length.
+    */
+  private def hasOpaqueLayout(td: TypeDef): Boolean =
+    td.name == "String"
+
   private def unwrapTypeGroup(typeSpec: Type): Type =
     typeSpec match
       case TypeGroup(_, types) if types.size == 1 => unwrapTypeGroup(types.head)
@@ -124,6 +124,9 @@ enum SemanticError extends CompilationError:
   case PartialApplicationWithConsuming(fn: Term, param: FnParam, phase: String)
   case ConditionalOwnershipMismatch(cond: Cond, phase: String)
   case BorrowEscapeViaReturn(ref: Ref, phase: String)
+  case ViewOutlivesParent(ref: Ref, view: String, phase: String)
+  case ViewOfTemporary(app: App, phase: String)
+  case ViewEscapesParent(view: Term, parent: String, phase: String)
 
   def message: String = this match
     case UndefinedRef(ref, _, _) =>
@@ -162,6 +165,12 @@ enum SemanticError extends CompilationError:
       "Conditional branches have different ownership states"
     case BorrowEscapeViaReturn(ref, _) =>
       s"Cannot return borrowed value '${ref.name}' from a function that returns a heap type"
+    case ViewOutlivesParent(ref, view, _) =>
+      s"Cannot move '${ref.name}' while its substring view '$view' is still used"
+    case ViewOfTemporary(_, _) =>
+      "Cannot take a substring view of a temporary; bind the string to a name first"
+    case ViewEscapesParent(_, parent, _) =>
+      s"A substring view of '$parent' cannot be returned or stored; copy it with substring"
 
 /** Generate a stable ID for stdlib members */
 private def stdlibId(declSegment: String, name: String): Option[String] =
@@ -173,15 +182,53 @@ private def stdlibTypeId(name: String): Option[String] =
   val segment = if stdlibAliasNames.contains(name) then "typealias" else "typedef"
   stdlibId(segment, name)
 
-/** Inject basic types with native mappings into the module.
+/** A scalar-element array family. All families share the `{length: Int64, data: <elem>*}` layout
+  * and the same native surface (`ar_<prefix>_new/set/get/len`, their `unsafe_` forms, and
+  * `__free_`/`__clone_`), which the runtime expands from one element-size-parametric template.
+  * Narrow integer elements are read and written as `Int`.
   */
-def injectBasicTypes(module: Module): Module =
+private[semantic] case class ArrayFamily(
+  typeName:  String,
+  prefix:    String,
+  ptrName:   String,
+  llvmElem:  String,
+  valueType: String
+)
+
+private[semantic] val arrayFamilies: List[ArrayFamily] = List(
+  ArrayFamily("IntArray", "int", "Int64Ptr", "i64", "Int"),
+  ArrayFamily("FloatArray", "float", "FloatPtr", "float", "Float"),
+  ArrayFamily("Int8Array", "i8", "Int8Ptr", "i8", "Int"),
+  ArrayFamily("Int32Array", "i32", "Int32Ptr", "i32", "Int"),
+  ArrayFamily("DoubleArray", "double", "DoublePtr", "double", "Double")
+)
+
+/** Stdlib types, built once per process; the AST is immutable, so every compile shares them. */
+private lazy val stdlibTypes: List[TypeDef | TypeAlias] =
   val syntheticSource = SourceOrigin.Synth
 
   // Helper to create a resolved TypeRef to a stdlib type
   def stdlibTypeRef(name: String): TypeRef =
     TypeRef(syntheticSource, name, stdlibTypeId(name), Nil)
 
+  // Every array is a heap-owned `{length, data}` struct over its element pointer type
+  def arrayStruct(name: String, ptrName: String): TypeDef =
+    TypeDef(
+      source   = SourceOrigin.Synth,
+      nameNode = Name.synth(name),
+      typeSpec = Some(
+        NativeStruct(
+          syntheticSource,
+          List(
+            "length" -> stdlibTypeRef("Int64"),
+            "data" -> stdlibTypeRef(ptrName)
+          ),
+          memEffect = Some(MemEffect.Alloc)
+        )
+      ),
+      id = stdlibId("typedef", name)
+    )
+
   val basicTypes: List[TypeDef | TypeAlias] = List(
     // Native type definitions with LLVM mappings
     TypeDef(
@@ -295,88 +342,95 @@ def injectBasicTypes(module: Module): Module =
       id       = stdlibId("typedef", "Buffer")
     ),
 
-    // Pointer types for arrays
+    // Input reader - opaque pointer to heap-allocated struct
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("Int64Ptr"),
-      typeSpec = Some(NativePointer(syntheticSource, "i64")),
-      id       = stdlibId("typedef", "Int64Ptr")
+      nameNode = Name.synth("Reader"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "Reader")
     ),
+
+    // Memory-mapped file - opaque pointer to heap-allocated struct, unmapped on free
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("StringPtr"),
-      typeSpec = Some(NativePointer(syntheticSource, "%struct.String")),
-      id       = stdlibId("typedef", "StringPtr")
+      nameNode = Name.synth("MappedFile"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "MappedFile")
     ),
+
+    // Event loop - opaque pointer to heap-allocated struct, closes its epoll/kqueue fd on free
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("FloatPtr"),
-      typeSpec = Some(NativePointer(syntheticSource, "float")),
-      id       = stdlibId("typedef", "FloatPtr")
+      nameNode = Name.synth("EventLoop"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "EventLoop")
     ),
 
-    // Monomorphic array types
+    // Swiss-table hash containers - opaque pointers, freed with their copied keys
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("IntArray"),
-      typeSpec = Some(
-        NativeStruct(
-          syntheticSource,
-          List(
-            "length" -> stdlibTypeRef("Int64"),
-            "data" -> stdlibTypeRef("Int64Ptr")
-          ),
-          memEffect = Some(MemEffect.Alloc)
-        )
-      ),
-      id = stdlibId("typedef", "IntArray")
+      nameNode = Name.synth("IntMap"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "IntMap")
     ),
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("StringArray"),
-      typeSpec = Some(
-        NativeStruct(
-          syntheticSource,
-          List(
-            "length" -> stdlibTypeRef("Int64"),
-            "data" -> stdlibTypeRef("StringPtr")
-          ),
-          memEffect = Some(MemEffect.Alloc)
-        )
-      ),
-      id = stdlibId("typedef", "StringArray")
+      nameNode = Name.synth("StringMap"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "StringMap")
     ),
     TypeDef(
       source   = SourceOrigin.Synth,
-      nameNode = Name.synth("FloatArray"),
-      typeSpec = Some(
-        NativeStruct(
-          syntheticSource,
-          List(
-            "length" -> stdlibTypeRef("Int64"),
-            "data" -> stdlibTypeRef("FloatPtr")
-          ),
-          memEffect = Some(MemEffect.Alloc)
-        )
+      nameNode = Name.synth("StringSet"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8", memEffect = Some(MemEffect.Alloc))),
+      id       = stdlibId("typedef", "StringSet")
+    ),
+
+    // String builder - opaque pointer, released by string_builder_finalize
+    TypeDef(
+      source   = SourceOrigin.Synth,
+      nameNode = Name.synth("StringBuilder"),
+      typeSpec = Some(NativePointer(syntheticSource, "i8")),
+      id       = stdlibId("typedef", "StringBuilder")
+    ),
+
+    // Pointer type for string arrays
+    TypeDef(
+      source   = SourceOrigin.Synth,
+      nameNode = Name.synth("StringPtr"),
+      typeSpec = Some(NativePointer(syntheticSource, "%struct.String")),
+      id       = stdlibId("typedef", "StringPtr")
+    ),
+    arrayStruct("StringArray", "StringPtr")
+  ) ++ arrayFamilies.flatMap { family =>
+    List(
+      TypeDef(
+        source   = SourceOrigin.Synth,
+        nameNode = Name.synth(family.ptrName),
+        typeSpec = Some(NativePointer(syntheticSource, family.llvmElem)),
+        id       = stdlibId("typedef", family.ptrName)
       ),
-      id = stdlibId("typedef", "FloatArray")
+      arrayStruct(family.typeName, family.ptrName)
     )
-  )
+  }
 
+  basicTypes
+
+/** Inject basic types with native mappings into the module.
+  */
+def injectBasicTypes(module: Module): Module =
   // Build resolvables index from stdlib types
-  val typeIndex = basicTypes.foldLeft(module.resolvables) { (idx, t) =>
+  val typeIndex = stdlibTypes.foldLeft(module.resolvables) { (idx, t) =>
     idx.updatedType(t)
   }
 
   module.copy(
-    members     = basicTypes ++ module.members,
+    members     = stdlibTypes ++ module.members,
     resolvables = typeIndex
   )
 
-/** This is required because we don't have multiple file, cross module capabilities
-  */
-def injectStandardOperators(module: Module): Module =
-
+/** Stdlib operators, built once per process. */
+private lazy val stdlibOperators: List[Bnd] =
   val syntheticSource = SourceOrigin.Synth
 
   // Helper to create a resolved TypeRef to a stdlib type
@@ -548,17 +602,20 @@ def injectStandardOperators(module: Module): Module =
     arithmeticOps ++ comparisonOps ++ logicalOps ++ unaryArithmeticOps ++ unaryLogicalOps ++
       floatArithmeticOps ++ floatComparisonOps ++ unaryFloatOps
 
+  standardOps
+
+/** This is required because we don't have multiple file, cross module capabilities
+  */
+def injectStandardOperators(module: Module): Module =
   // Build resolvables index from stdlib operators
-  val opIndex = standardOps.foldLeft(module.resolvables) { (idx, bnd) =>
+  val opIndex = stdlibOperators.foldLeft(module.resolvables) { (idx, bnd) =>
     idx.updated(bnd)
   }
 
-  module.copy(members = standardOps ++ module.members, resolvables = opIndex)
+  module.copy(members = stdlibOperators ++ module.members, resolvables = opIndex)
 
-/** Inject common native functions that are repeatedly defined across samples. Includes print,
-  * println, readline, concat, to_string, and str_to_int functions.
-  */
-def injectCommonFunctions(module: Module): Module =
+/** Stdlib functions, built once per process. */
+private lazy val stdlibFunctions: List[Bnd] =
   val syntheticSource = SourceOrigin.Synth
 
   // Helper to create a resolved TypeRef to a stdlib type
@@ -570,8 +627,13 @@ def injectCommonFunctions(module: Module): Module =
   def intType    = stdlibTypeRef("Int")
   def boolType   = stdlibTypeRef("Bool")
   def floatType  = stdlibTypeRef("Float")
+  def doubleType = stdlibTypeRef("Double")
   def unitType   = stdlibTypeRef("Unit")
   def bufferType = stdlibTypeRef("Buffer")
+  def sbType     = stdlibTypeRef("StringBuilder")
+  def readerType = stdlibTypeRef("Reader")
+  def mappedType = stdlibTypeRef("MappedFile")
+  def eventLoopType = stdlibTypeRef("EventLoop")
 
   // Helper to create a function as Bnd(Lambda)
   def mkFn(
@@ -710,6 +772,9 @@ def injectCommonFunctions(module: Module): Module =
       unitType
     ),
     mkFn("mml_sys_flush", List(), unitType),
+    // Region arena: allocations between push and pop are released together
+    mkFn("mml_arena_push", List(), unitType),
+    mkFn("mml_arena_pop", List(), unitType),
     mkFn("readline", List(), stringType, Some(MemEffect.Alloc)),
     mkFn(
       "concat",
@@ -740,11 +805,63 @@ def injectCommonFunctions(module: Module): Module =
       stringType,
       Some(MemEffect.Alloc)
     ),
+    mkFn(
+      "double_to_str",
+      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(doubleType))),
+      stringType,
+      Some(MemEffect.Alloc)
+    ),
     mkFn(
       "str_to_int",
       List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(stringType))),
       intType
     ),
+    mkFn(
+      "str_len",
+      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(stringType))),
+      intType
+    ),
+    mkFn(
+      "substring",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("s"), typeAsc = Some(stringType)),
+        FnParam(SourceOrigin.Synth, Name.synth("start"), typeAsc = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("len"), typeAsc = Some(intType))
+      ),
+      stringType,
+      Some(MemEffect.Alloc)
+    ),
+    // Borrowed slice of `s`; OwnershipAnalyzer keeps it from outliving `s`
+    mkFn(
+      "substring_view",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("s"), typeAsc = Some(stringType)),
+        FnParam(SourceOrigin.Synth, Name.synth("start"), typeAsc = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("len"), typeAsc = Some(intType))
+      ),
+      stringType,
+      Some(MemEffect.Static)
+    ),
+    // String builder: targets of the Simplifier's `++` chain lowering
+    mkFn(
+      "string_builder_new",
+      List(FnParam(SourceOrigin.Synth, Name.synth("capacity"), typeAsc = Some(intType))),
+      sbType
+    ),
+    mkFn(
+      "string_builder_append",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("sb"), typeAsc = Some(sbType)),
+        FnParam(SourceOrigin.Synth, Name.synth("s"), typeAsc = Some(stringType))
+      ),
+      sbType
+    ),
+    mkFn(
+      "string_builder_finalize",
+      List(FnParam(SourceOrigin.Synth, Name.synth("sb"), typeAsc = Some(sbType))),
+      stringType,
+      Some(MemEffect.Alloc)
+    ),
     // Buffer functions
     mkFn("mkBuffer", List(), bufferType, Some(MemEffect.Alloc)),
     mkFn(
@@ -812,6 +929,22 @@ def injectCommonFunctions(module: Module): Module =
       ),
       unitType
     ),
+    mkFn(
+      "buffer_write_double",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(bufferType)),
+        FnParam(SourceOrigin.Synth, Name.synth("n"), typeAsc = Some(doubleType))
+      ),
+      unitType
+    ),
+    mkFn(
+      "buffer_writeln_double",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(bufferType)),
+        FnParam(SourceOrigin.Synth, Name.synth("n"), typeAsc = Some(doubleType))
+      ),
+      unitType
+    ),
     // Conversion functions (template-based)
     mkFnWithTpl(
       "int_to_float",
@@ -825,6 +958,18 @@ def injectCommonFunctions(module: Module): Module =
       intType,
       "fptosi float %operand to i64"
     ),
+    mkFnWithTpl(
+      "float_to_double",
+      List(FnParam(SourceOrigin.Synth, Name.synth("f"), typeAsc = Some(floatType))),
+      doubleType,
+      "fpext float %operand to double"
+    ),
+    mkFnWithTpl(
+      "double_to_float",
+      List(FnParam(SourceOrigin.Synth, Name.synth("d"), typeAsc = Some(doubleType))),
+      floatType,
+      "fptrunc double %operand to float"
+    ),
     mkFnWithTpl(
       "sqrt",
       List(FnParam(SourceOrigin.Synth, Name.synth("x"), typeAsc = Some(floatType))),
@@ -864,6 +1009,48 @@ def injectCommonFunctions(module: Module): Module =
       stringType,
       Some(MemEffect.Alloc)
     ),
+    // Buffered reader functions
+    mkFn(
+      "mkReader",
+      List(FnParam(SourceOrigin.Synth, Name.synth("fd"), typeAsc = Some(intType))),
+      readerType,
+      Some(MemEffect.Alloc)
+    ),
+    mkFn(
+      "reader_next_line",
+      List(FnParam(SourceOrigin.Synth, Name.synth("r"), typeAsc = Some(readerType))),
+      stringType,
+      Some(MemEffect.Alloc)
+    ),
+    mkFn(
+      "reader_eof",
+      List(FnParam(SourceOrigin.Synth, Name.synth("r"), typeAsc = Some(readerType))),
+      boolType
+    ),
+    mkFn(
+      "reader_poll",
+      List(FnParam(SourceOrigin.Synth, Name.synth("r"), typeAsc = Some(readerType))),
+      boolType
+    ),
+    // Memory-mapped file functions
+    mkFn(
+      "mmap_file",
+      List(FnParam(SourceOrigin.Synth, Name.synth("path"), typeAsc = Some(stringType))),
+      mappedType,
+      Some(MemEffect.Alloc)
+    ),
+    mkFn(
+      "mapped_len",
+      List(FnParam(SourceOrigin.Synth, Name.synth("m"), typeAsc = Some(mappedType))),
+      intType
+    ),
+    // Borrowed view of the mapping; OwnershipAnalyzer keeps it from outliving `m`
+    mkFn(
+      "mapped_as_string",
+      List(FnParam(SourceOrigin.Synth, Name.synth("m"), typeAsc = Some(mappedType))),
+      stringType,
+      Some(MemEffect.Static)
+    ),
     // Memory management free functions - params are consuming (take ownership)
     mkFn(
       "__free_String",
@@ -878,6 +1065,32 @@ def injectCommonFunctions(module: Module): Module =
         FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(bufferType), consuming = true)
       ),
       unitType
+    ),
+    mkFn(
+      "__free_Reader",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("r"), typeAsc = Some(readerType), consuming = true)
+      ),
+      unitType
+    ),
+    mkFn(
+      "__free_MappedFile",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("m"), typeAsc = Some(mappedType), consuming = true)
+      ),
+      unitType
+    ),
+    mkFn(
+      "__free_EventLoop",
+      List(
+        FnParam(
+          SourceOrigin.Synth,
+          Name.synth("loop"),
+          typeAsc   = Some(eventLoopType),
+          consuming = true
+        )
+      ),
+      unitType
     )
   )
 
@@ -886,54 +1099,108 @@ def injectCommonFunctions(module: Module): Module =
   def stringArrayType = stdlibTypeRef("StringArray")
   def floatArrayType  = stdlibTypeRef("FloatArray")
 
+  // Natives shared by every scalar array family (see `arrayFamilies`)
+  def arrayFamilyFunctions(family: ArrayFamily): List[Bnd] =
+    val arrType   = stdlibTypeRef(family.typeName)
+    val valueType = stdlibTypeRef(family.valueType)
+    def arr       = FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(arrType))
+    def idx       = FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc = Some(intType))
+    def value     = FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(valueType))
+    val p         = family.prefix
+    List(
+      mkFn(
+        s"ar_${p}_new",
+        List(FnParam(SourceOrigin.Synth, Name.synth("size"), typeAsc = Some(intType))),
+        arrType,
+        Some(MemEffect.Alloc)
+      ),
+      mkFn(s"ar_${p}_set", List(arr, idx, value), unitType),
+      mkFn(s"ar_${p}_get", List(arr, idx), valueType),
+      mkFn(s"unsafe_ar_${p}_set", List(arr, idx, value), unitType),
+      mkFn(s"unsafe_ar_${p}_get", List(arr, idx), valueType),
+      mkFn(s"ar_${p}_len", List(arr), intType),
+      mkFn(
+        s"__free_${family.typeName}",
+        List(
+          FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(arrType), consuming = true)
+        ),
+        unitType
+      ),
+      mkFn(
+        s"__clone_${family.typeName}",
+        List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(arrType))),
+        arrType,
+        Some(MemEffect.Alloc)
+      )
+    )
+
   // Array functions
-  val arrayFunctions = List(
-    // IntArray functions
+  val arrayFunctions = arrayFamilies.flatMap(arrayFamilyFunctions) ++ List(
+    // Bulk IntArray kernels (vectorized in the runtime)
     mkFn(
-      "ar_int_new",
-      List(FnParam(SourceOrigin.Synth, Name.synth("size"), typeAsc = Some(intType))),
-      intArrayType,
-      Some(MemEffect.Alloc)
-    ),
-    mkFn(
-      "ar_int_set",
+      "ar_int_fill",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc   = Some(intArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc   = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType)),
         FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(intType))
       ),
       unitType
     ),
     mkFn(
-      "ar_int_get",
+      "ar_int_copy_range",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc = Some(intType))
+        FnParam(SourceOrigin.Synth, Name.synth("dst"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("dstStart"), typeAsc = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("src"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("srcStart"), typeAsc = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("len"), typeAsc = Some(intType))
       ),
+      unitType
+    ),
+    mkFn(
+      "ar_int_sum",
+      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType))),
       intType
     ),
     mkFn(
-      "unsafe_ar_int_set",
+      "ar_int_count_eq",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc   = Some(intArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc   = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType)),
         FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(intType))
       ),
+      intType
+    ),
+    // Sorting and searching
+    mkFn(
+      "ar_int_sort",
+      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType))),
       unitType
     ),
     mkFn(
-      "unsafe_ar_int_get",
+      "ar_int_lower_bound",
       List(
         FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc = Some(intType))
+        FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(intType))
       ),
       intType
     ),
     mkFn(
-      "ar_int_len",
-      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType))),
+      "ar_int_binary_search",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(intType))
+      ),
       intType
     ),
+    mkFn(
+      "ar_float_sort",
+      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(floatArrayType))),
+      unitType
+    ),
+    mkFn(
+      "ar_str_sort",
+      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(stringArrayType))),
+      unitType
+    ),
     // StringArray functions
     mkFn(
       "ar_str_new",
@@ -968,79 +1235,59 @@ def injectCommonFunctions(module: Module): Module =
       List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(stringArrayType))),
       intType
     ),
-    // FloatArray functions
-    mkFn(
-      "ar_float_new",
-      List(FnParam(SourceOrigin.Synth, Name.synth("size"), typeAsc = Some(intType))),
-      floatArrayType,
-      Some(MemEffect.Alloc)
-    ),
-    mkFn(
-      "ar_float_set",
-      List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc   = Some(floatArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc   = Some(intType)),
-        FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(floatType))
-      ),
-      unitType
-    ),
+    // Bulk FloatArray kernels (vectorized in the runtime)
     mkFn(
-      "ar_float_get",
+      "ar_float_dot",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(floatArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc = Some(intType))
+        FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(floatArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(floatArrayType))
       ),
       floatType
     ),
     mkFn(
-      "unsafe_ar_float_set",
+      "ar_float_axpy",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc   = Some(floatArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc   = Some(intType)),
-        FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(floatType))
+        FnParam(SourceOrigin.Synth, Name.synth("alpha"), typeAsc = Some(floatType)),
+        FnParam(SourceOrigin.Synth, Name.synth("x"), typeAsc = Some(floatArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("y"), typeAsc = Some(floatArrayType))
       ),
       unitType
     ),
+    // Parallel kernels: run on the runtime's work-stealing pool
+    mkFn("par_workers", List(), intType),
     mkFn(
-      "unsafe_ar_float_get",
+      "ar_int_matmul",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(floatArrayType)),
-        FnParam(SourceOrigin.Synth, Name.synth("idx"), typeAsc = Some(intType))
+        FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("c"), typeAsc = Some(intArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("n"), typeAsc = Some(intType))
       ),
-      floatType
-    ),
-    mkFn(
-      "ar_float_len",
-      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(floatArrayType))),
-      intType
+      unitType
     ),
-    // Memory management free functions for arrays - params are consuming
     mkFn(
-      "__free_IntArray",
+      "ar_float_matmul",
       List(
-        FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(intArrayType), consuming = true)
+        FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(floatArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(floatArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("c"), typeAsc = Some(floatArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("n"), typeAsc = Some(intType))
       ),
       unitType
     ),
     mkFn(
-      "__free_StringArray",
-      List(
-        FnParam(
-          SourceOrigin.Synth,
-          Name.synth("a"),
-          typeAsc   = Some(stringArrayType),
-          consuming = true
-        )
-      ),
+      "ar_int_par_sort",
+      List(FnParam(SourceOrigin.Synth, Name.synth("arr"), typeAsc = Some(intArrayType))),
       unitType
     ),
+    // Memory management free functions for arrays - params are consuming
     mkFn(
-      "__free_FloatArray",
+      "__free_StringArray",
       List(
         FnParam(
           SourceOrigin.Synth,
           Name.synth("a"),
-          typeAsc   = Some(floatArrayType),
+          typeAsc   = Some(stringArrayType),
           consuming = true
         )
       ),
@@ -1060,21 +1307,27 @@ def injectCommonFunctions(module: Module): Module =
       Some(MemEffect.Alloc)
     ),
     mkFn(
-      "__clone_IntArray",
-      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(intArrayType))),
-      intArrayType,
+      "__clone_Reader",
+      List(FnParam(SourceOrigin.Synth, Name.synth("r"), typeAsc = Some(readerType))),
+      readerType,
       Some(MemEffect.Alloc)
     ),
     mkFn(
-      "__clone_StringArray",
-      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(stringArrayType))),
-      stringArrayType,
+      "__clone_MappedFile",
+      List(FnParam(SourceOrigin.Synth, Name.synth("m"), typeAsc = Some(mappedType))),
+      mappedType,
+      Some(MemEffect.Alloc)
+    ),
+    mkFn(
+      "__clone_EventLoop",
+      List(FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType))),
+      eventLoopType,
       Some(MemEffect.Alloc)
     ),
     mkFn(
-      "__clone_FloatArray",
-      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(floatArrayType))),
-      floatArrayType,
+      "__clone_StringArray",
+      List(FnParam(SourceOrigin.Synth, Name.synth("a"), typeAsc = Some(stringArrayType))),
+      stringArrayType,
       Some(MemEffect.Alloc)
     )
   )
@@ -1134,14 +1387,177 @@ def injectCommonFunctions(module: Module): Module =
     mkBinOpExpr("++", 61, Associativity.Right, "concat", stringType, stringType, stringType)
   )
 
-  val allFunctions = commonFunctions ++ arrayFunctions ++ bufferOps ++ stringOps
+  // Process execution (posix_spawn in the runtime); `args` excludes argv[0]
+  val processFunctions = List(
+    mkFn(
+      "run_cmd",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("cmd"), typeAsc = Some(stringType)),
+        FnParam(SourceOrigin.Synth, Name.synth("args"), typeAsc = Some(stringArrayType))
+      ),
+      intType
+    ),
+    mkFn(
+      "run_cmd_into",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("cmd"), typeAsc = Some(stringType)),
+        FnParam(SourceOrigin.Synth, Name.synth("args"), typeAsc = Some(stringArrayType)),
+        FnParam(SourceOrigin.Synth, Name.synth("out"), typeAsc = Some(bufferType))
+      ),
+      intType
+    ),
+    mkFn(
+      "run_cmd_capture",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("cmd"), typeAsc = Some(stringType)),
+        FnParam(SourceOrigin.Synth, Name.synth("args"), typeAsc = Some(stringArrayType))
+      ),
+      stringType,
+      Some(MemEffect.Alloc)
+    )
+  )
+
+  // Readiness event loop (epoll / kqueue / poll in the runtime); events are 1 = read, 2 = write
+  val eventLoopFunctions = List(
+    mkFn("ev_new", List(), eventLoopType, Some(MemEffect.Alloc)),
+    mkFn(
+      "ev_watch",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("fd"), typeAsc = Some(intType)),
+        FnParam(SourceOrigin.Synth, Name.synth("events"), typeAsc = Some(intType))
+      ),
+      unitType
+    ),
+    mkFn(
+      "ev_unwatch",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("fd"), typeAsc = Some(intType))
+      ),
+      unitType
+    ),
+    mkFn(
+      "ev_wait",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("timeout_ms"), typeAsc = Some(intType))
+      ),
+      intType
+    ),
+    mkFn(
+      "ev_ready_fd",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("i"), typeAsc = Some(intType))
+      ),
+      intType
+    ),
+    mkFn(
+      "ev_ready_events",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("i"), typeAsc = Some(intType))
+      ),
+      intType
+    ),
+    mkFn(
+      "ev_flush",
+      List(
+        FnParam(SourceOrigin.Synth, Name.synth("loop"), typeAsc = Some(eventLoopType)),
+        FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(bufferType))
+      ),
+      intType
+    ),
+    mkFn(
+      "buffer_flush_nb",
+      List(FnParam(SourceOrigin.Synth, Name.synth("b"), typeAsc = Some(bufferType))),
+      intType
+    ),
+    mkFn(
+      "set_nonblocking",
+      List(FnParam(SourceOrigin.Synth, Name.synth("fd"), typeAsc = Some(intType))),
+      intType
+    ),
+    mkFn("open_pipe", List(), intArrayType, Some(MemEffect.Alloc))
+  )
+
+  // Hash containers (Swiss tables in the runtime). Keys are borrowed: the table copies them.
+  def hashTableFunctions(
+    typeName: String,
+    prefix:   String,
+    keyType:  Type,
+    keysType: Type
+  ): List[Bnd] =
+    val tableType = stdlibTypeRef(typeName)
+    def table     = FnParam(SourceOrigin.Synth, Name.synth("t"), typeAsc = Some(tableType))
+    def key       = FnParam(SourceOrigin.Synth, Name.synth("key"), typeAsc = Some(keyType))
+    def value     = FnParam(SourceOrigin.Synth, Name.synth("value"), typeAsc = Some(intType))
+    val accessors =
+      if typeName == "StringSet" then
+        List(
+          mkFn(s"${prefix}_add", List(table, key), unitType),
+          mkFn(s"${prefix}_items", List(table), keysType, Some(MemEffect.Alloc))
+        )
+      else
+        List(
+          mkFn(s"${prefix}_put", List(table, key, value), unitType),
+          mkFn(
+            s"${prefix}_get",
+            List(
+              table,
+              key,
+              FnParam(SourceOrigin.Synth, Name.synth("missing"), typeAsc = Some(intType))
+            ),
+            intType
+          ),
+          mkFn(
+            s"${prefix}_add",
+            List(
+              table,
+              key,
+              FnParam(SourceOrigin.Synth, Name.synth("delta"), typeAsc = Some(intType))
+            ),
+            unitType
+          ),
+          mkFn(s"${prefix}_keys", List(table), keysType, Some(MemEffect.Alloc))
+        )
+    List(
+      mkFn(s"${prefix}_new", List(), tableType, Some(MemEffect.Alloc)),
+      mkFn(s"${prefix}_has", List(table, key), boolType),
+      mkFn(s"${prefix}_remove", List(table, key), unitType),
+      mkFn(s"${prefix}_len", List(table), intType),
+      mkFn(
+        s"__free_$typeName",
+        List(
+          FnParam(SourceOrigin.Synth, Name.synth("t"), typeAsc = Some(tableType), consuming = true)
+        ),
+        unitType
+      ),
+      mkFn(s"__clone_$typeName", List(table), tableType, Some(MemEffect.Alloc))
+    ) ++ accessors
+
+  val tableFunctions =
+    hashTableFunctions("IntMap", "imap", intType, intArrayType) ++
+      hashTableFunctions("StringMap", "smap", stringType, stringArrayType) ++
+      hashTableFunctions("StringSet", "sset", stringType, stringArrayType)
+
+  val allFunctions =
+    commonFunctions ++ arrayFunctions ++ bufferOps ++ stringOps ++ processFunctions ++
+      eventLoopFunctions ++ tableFunctions
 
+  allFunctions
+
+/** Inject common native functions that are repeatedly defined across samples. Includes print,
+  * println, readline, concat, to_string, and str_to_int functions.
+  */
+def injectCommonFunctions(module: Module): Module =
   // Build resolvables index from stdlib functions
-  val fnIndex = allFunctions.foldLeft(module.resolvables) { (idx, bnd) =>
+  val fnIndex = stdlibFunctions.foldLeft(module.resolvables) { (idx, bnd) =>
     idx.updated(bnd)
   }
 
-  module.copy(members = allFunctions ++ module.members, resolvables = fnIndex)
+  module.copy(members = stdlibFunctions ++ module.members, resolvables = fnIndex)
 
 def collectBadRefs(expr: Expr, module: Module): List[Ref] =
   expr.terms.foldLeft(List.empty[Ref]) {
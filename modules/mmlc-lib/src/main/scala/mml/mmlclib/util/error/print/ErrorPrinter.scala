@@ -69,6 +69,9 @@ object ErrorPrinter:
     case SemanticError.PartialApplicationWithConsuming(fn, _, _) => startPosOf(fn)
     case SemanticError.ConditionalOwnershipMismatch(cond, _) => startPosOf(cond)
     case SemanticError.BorrowEscapeViaReturn(ref, _) => startPosOf(ref)
+    case SemanticError.ViewOutlivesParent(ref, _, _) => startPosOf(ref)
+    case SemanticError.ViewOfTemporary(app, _) => startPosOf(app)
+    case SemanticError.ViewEscapesParent(view, _, _) => startPosOf(view)
     case SemanticError.VisibilityViolation(ref, _, _) => startPosOf(ref)
     case SemanticError.TypeCheckingError(error) =>
       // For type errors, we need to extract the position from the nested error
@@ -212,6 +215,15 @@ object ErrorPrinter:
       case SemanticError.BorrowEscapeViaReturn(ref, phase) =>
         s"${Console.RED}Cannot return borrowed value '${ref.name}' at ${locationOf(ref)}${Console.RESET}\n${Console.YELLOW}Phase: $phase${Console.RESET}"
 
+      case SemanticError.ViewOutlivesParent(ref, view, phase) =>
+        s"${Console.RED}Cannot move '${ref.name}' at ${locationOf(ref)} while its substring view '$view' is still used${Console.RESET}\n${Console.YELLOW}Phase: $phase${Console.RESET}"
+
+      case SemanticError.ViewOfTemporary(app, phase) =>
+        s"${Console.RED}Cannot take a substring view of a temporary at ${locationOf(app)}${Console.RESET}\n${Console.YELLOW}Phase: $phase${Console.RESET}"
+
+      case SemanticError.ViewEscapesParent(view, parent, phase) =>
+        s"${Console.RED}Substring view of '$parent' at ${locationOf(view)} cannot be returned or stored${Console.RESET}\n${Console.YELLOW}Phase: $phase${Console.RESET}"
+
       case SemanticError.TypeCheckingError(error) =>
         // Delegate to SemanticErrorPrinter to avoid duplication
         SemanticErrorPrinter.prettyPrintTypeError(error)
@@ -145,6 +145,18 @@ object SemanticErrorPrinter:
         val location = locationOf(ref)
         s"${Console.RED}Cannot return borrowed value '${ref.name}' at $location [phase: $phase]${Console.RESET}"
 
+      case SemanticError.ViewOutlivesParent(ref, view, phase) =>
+        val location = locationOf(ref)
+        s"${Console.RED}Cannot move '${ref.name}' at $location while its substring view '$view' is still used [phase: $phase]${Console.RESET}"
+
+      case SemanticError.ViewOfTemporary(app, phase) =>
+        val location = locationOf(app)
+        s"${Console.RED}Cannot take a substring view of a temporary at $location [phase: $phase]${Console.RESET}"
+
+      case SemanticError.ViewEscapesParent(view, parent, phase) =>
+        val location = locationOf(view)
+        s"${Console.RED}Substring view of '$parent' at $location cannot be returned or stored [phase: $phase]${Console.RESET}"
+
       case SemanticError.TypeCheckingError(error) =>
         prettyPrintTypeError(error)
 
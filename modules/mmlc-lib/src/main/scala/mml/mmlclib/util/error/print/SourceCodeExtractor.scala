@@ -139,6 +139,24 @@ object SourceCodeExtractor:
           .map(s => s"\n$s")
           .getOrElse("")
 
+      case SemanticError.ViewOutlivesParent(ref, _, _) =>
+        spanOf(ref)
+          .flatMap(extractSnippet(sourceInfo, _))
+          .map(s => s"\n$s")
+          .getOrElse("")
+
+      case SemanticError.ViewOfTemporary(app, _) =>
+        spanOf(app)
+          .flatMap(extractSnippet(sourceInfo, _))
+          .map(s => s"\n$s")
+          .getOrElse("")
+
+      case SemanticError.ViewEscapesParent(view, _, _) =>
+        spanOf(view)
+          .flatMap(extractSnippet(sourceInfo, _))
+          .map(s => s"\n$s")
+          .getOrElse("")
+
       case SemanticError.VisibilityViolation(ref, _, _) =>
         spanOf(ref)
           .flatMap(extractSnippet(sourceInfo, _))
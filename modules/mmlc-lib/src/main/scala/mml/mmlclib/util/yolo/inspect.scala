@@ -132,10 +132,16 @@ def rewrite(
     s"Resolvables Indexer phase \n${prettyPrintAst(state8.module, showTypes = showTypes, showSourceSpans = showSpans)}"
   )
 
-  val finalState = TailRecursionDetector.rewriteModule(state8)
+  val state9 = TailRecursionDetector.rewriteModule(state8)
   println("-" * 80)
   println(
-    s"Tail Recursion phase \n${prettyPrintAst(finalState.module, showTypes = showTypes, showSourceSpans = showSpans)}"
+    s"Tail Recursion phase \n${prettyPrintAst(state9.module, showTypes = showTypes, showSourceSpans = showSpans)}"
+  )
+
+  val finalState = BoundsCheckEliminator.rewriteModule(state9)
+  println("-" * 80)
+  println(
+    s"Bounds Check Elimination phase \n${prettyPrintAst(finalState.module, showTypes = showTypes, showSourceSpans = showSpans)}"
   )
 
   val validated = CodegenStage.validate(finalState)
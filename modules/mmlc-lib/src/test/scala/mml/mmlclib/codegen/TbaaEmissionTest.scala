@@ -222,3 +222,40 @@ class TbaaEmissionTest extends BaseEffFunSuite:
     assertEquals(StructLayout.sizeOf(outerStruct, resolvables), Right(24))
     assertEquals(StructLayout.alignOf(outerStruct, resolvables), Right(8))
   }
+
+  test("StructLayout accepts {length, data} arrays and rejects other shapes") {
+    val resolvables = ResolvablesIndex()
+    val ok = List(
+      ("length", NativePrimitive(span, "i64")),
+      ("data", NativePointer(span, "i8"))
+    )
+    val swapped = List(
+      ("data", NativePointer(span, "i8")),
+      ("length", NativePrimitive(span, "i64"))
+    )
+    val narrowLength = List(
+      ("length", NativePrimitive(span, "i32")),
+      ("data", NativePointer(span, "i8"))
+    )
+
+    assertEquals(StructLayout.checkArrayLayout("Int8Array", ok, resolvables), Right(()))
+    assert(StructLayout.checkArrayLayout("Int8Array", swapped, resolvables).isLeft)
+    assert(StructLayout.checkArrayLayout("Int8Array", narrowLength, resolvables).isLeft)
+  }
+
+  test("every array family gets its own TBAA struct node") {
+    val source = """
+      fn main(): Unit =
+        let a = ar_i8_new 4;
+        ar_i8_set a 0 1;
+        println (int_to_str (ar_i8_get a 0))
+      ;
+    """
+
+    compileAndGenerate(source).map { llvmIr =>
+      List("IntArray", "FloatArray", "Int8Array", "Int32Array", "DoubleArray", "StringArray")
+        .foreach { name =>
+          assert(llvmIr.contains(s"!{!\"$name\""), s"Missing $name TBAA struct node")
+        }
+    }
+  }
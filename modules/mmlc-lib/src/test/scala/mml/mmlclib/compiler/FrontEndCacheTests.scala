@@ -0,0 +1,39 @@
+package mml.mmlclib.compiler
+
+import mml.mmlclib.test.BaseEffFunSuite
+
+class FrontEndCacheTests extends BaseEffFunSuite:
+
+  private val config = CompilerConfig.default
+
+  private def compile(cache: FrontEndCache, source: String) =
+    Compilation.compileSourceCached(cache, source, "Test", "test.mml", config)
+
+  test("unchanged source reuses the earlier state") {
+    val source = "fn main(): Unit = println \"hi\";"
+    for
+      cache  <- FrontEndCache.create()
+      first  <- compile(cache, source)
+      second <- compile(cache, source)
+    yield assert(first eq second, "Expected the cached state")
+  }
+
+  test("edited source is compiled again") {
+    for
+      cache  <- FrontEndCache.create()
+      first  <- compile(cache, "let a = 1;")
+      second <- compile(cache, "let a = 2;")
+      again  <- compile(cache, "let a = 1;")
+    yield
+      assert(first ne second, "Expected a fresh compile for new source")
+      assert(first eq again, "Expected the first state after undoing the edit")
+  }
+
+  test("least recently used entry is evicted") {
+    for
+      cache <- FrontEndCache.create(capacity = 1)
+      first <- compile(cache, "let a = 1;")
+      _     <- compile(cache, "let a = 2;")
+      again <- compile(cache, "let a = 1;")
+    yield assert(first ne again, "Expected the evicted entry to be recompiled")
+  }
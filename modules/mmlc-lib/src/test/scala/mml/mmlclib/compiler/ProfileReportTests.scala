@@ -0,0 +1,50 @@
+package mml.mmlclib.compiler
+
+import cats.effect.IO
+import mml.mmlclib.api.FrontEndApi
+import mml.mmlclib.test.BaseEffFunSuite
+
+class ProfileReportTests extends BaseEffFunSuite:
+
+  private def compileState(code: String): IO[CompilerState] =
+    FrontEndApi.compile(code, "Test").value.map {
+      case Right(state) => state
+      case Left(error) => fail(s"Compilation failed: $error")
+    }
+
+  private def counterNames(json: ujson.Value): List[String] =
+    json("counters").arr.map(c => s"${c("stage").str}/${c("name").str}").toList
+
+  test("profile has one phase and one trace event per timing") {
+    compileState("fn main(): Unit = println \"hi\";").map { state =>
+      val json   = ProfileReport.toJson(state)
+      val phases = json("phases").arr
+      assertEquals(phases.size, state.timings.size)
+      assertEquals(json("traceEvents").arr.size, state.timings.size)
+      assert(phases.exists(_("name").str == "type-checker"), s"Missing type-checker: $phases")
+      assert(json("traceEvents").arr.forall(_("ph").str == "X"))
+      assert(phases.forall(_("startNanos").num >= 0), s"Negative start offset: $phases")
+    }
+  }
+
+  test("profile carries parser and AST counters") {
+    compileState("let a = 1 + 2;").map { state =>
+      val names = counterNames(ProfileReport.toJson(state))
+      assert(names.contains("ingest/backtracks"), s"Missing parser counters: $names")
+      assert(names.contains("ingest/ast-terms"), s"Missing ingest AST counters: $names")
+      assert(names.contains("semantic/ast-members"), s"Missing semantic AST counters: $names")
+    }
+  }
+
+  test("profile is written as parseable JSON") {
+    for
+      state <- compileState("let a = 1;")
+      path  <- IO.blocking(java.nio.file.Files.createTempFile("mml-profile", ".json"))
+      _     <- ProfileReport.write(path, state)
+      text  <- IO.blocking(java.nio.file.Files.readString(path))
+      _     <- IO.blocking(java.nio.file.Files.deleteIfExists(path))
+    yield
+      val json = ujson.read(text)
+      assertEquals(json("version").num.toInt, ProfileReport.formatVersion)
+      assertEquals(json("module").str, "Test")
+  }
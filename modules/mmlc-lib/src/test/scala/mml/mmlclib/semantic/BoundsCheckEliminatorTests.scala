@@ -0,0 +1,139 @@
+package mml.mmlclib.semantic
+
+import cats.effect.IO
+import mml.mmlclib.api.FrontEndApi
+import mml.mmlclib.ast.*
+import mml.mmlclib.compiler.CompilerState
+import mml.mmlclib.test.BaseEffFunSuite
+
+class BoundsCheckEliminatorTests extends BaseEffFunSuite:
+
+  private def compileState(code: String): IO[CompilerState] =
+    FrontEndApi.compile(code, "Test").value.map {
+      case Right(state) if state.errors.isEmpty => state
+      case Right(state) => fail(s"Compilation failed: ${state.errors}")
+      case Left(error) => fail(s"Compilation failed: $error")
+    }
+
+  private def counter(state: CompilerState, name: String): Long =
+    state.counters.find(c => c.stage == "semantic" && c.name == name).map(_.value).getOrElse(-1L)
+
+  /** Names of every function referenced in the body of `fnName`. */
+  private def calledNames(fnName: String, m: Module): List[String] =
+    def inExpr(e: Expr): List[String] = e.terms.flatMap(inTerm)
+    def inTerm(t: Term): List[String] = t match
+      case e:   Expr => inExpr(e)
+      case ref: Ref => List(ref.name)
+      case app: App => inTerm(app.fn) ++ inExpr(app.arg)
+      case c:   Cond => inExpr(c.cond) ++ inExpr(c.ifTrue) ++ inExpr(c.ifFalse)
+      case l:   Lambda => inExpr(l.body)
+      case _ => Nil
+    lookupNames(fnName, m).headOption match
+      case Some(bnd: Bnd) => inExpr(bnd.value)
+      case other => fail(s"Expected binding `$fnName`, got: $other")
+
+  test("loop bounded by ar_int_len uses unchecked accesses") {
+    val code =
+      """
+      fn sum(arr: IntArray, i: Int, n: Int, acc: Int): Int =
+        if i < n then sum arr (i + 1) n (acc + ar_int_get arr i)
+        else acc
+        end
+      ;
+      fn main(): Unit =
+        let arr = ar_int_new 10;
+        println (int_to_str (sum arr 0 (ar_int_len arr) 0))
+      ;
+      """
+
+    compileState(code).map { state =>
+      val names = calledNames("sum", state.module)
+      assert(names.contains("unsafe_ar_int_get"), s"Expected unchecked get, got: $names")
+      assert(!names.contains("ar_int_get"), s"Checked get left in loop: $names")
+      assertEquals(counter(state, "bounds-checks-removed"), 1L)
+      assertEquals(counter(state, "bounds-checks-kept"), 0L)
+    }
+  }
+
+  test("loop bounded by the allocation size uses unchecked accesses") {
+    val code =
+      """
+      fn fill(arr: Int8Array, i: Int, size: Int): Unit =
+        if i >= size then ()
+        else
+          ar_i8_set arr i 1;
+          fill arr (i + 1) size
+        end
+      ;
+      fn main(): Unit =
+        let size = 100;
+        let arr = ar_i8_new size;
+        fill arr 0 size;
+        println (int_to_str (ar_i8_len arr))
+      ;
+      """
+
+    compileState(code).map { state =>
+      val names = calledNames("fill", state.module)
+      assert(names.contains("unsafe_ar_i8_set"), s"Expected unchecked set, got: $names")
+      assertEquals(counter(state, "bounds-checks-removed"), 1L)
+    }
+  }
+
+  test("index that may be negative keeps its check") {
+    val code =
+      """
+      fn sum(arr: IntArray, i: Int, n: Int, acc: Int): Int =
+        if i < n then sum arr (i + 1) n (acc + ar_int_get arr i)
+        else acc
+        end
+      ;
+      fn main(): Unit =
+        let arr = ar_int_new 10;
+        println (int_to_str (sum arr (0 - 3) (ar_int_len arr) 0))
+      ;
+      """
+
+    compileState(code).map { state =>
+      val names = calledNames("sum", state.module)
+      assert(names.contains("ar_int_get"), s"Expected checked get, got: $names")
+      assertEquals(counter(state, "bounds-checks-removed"), 0L)
+      assertEquals(counter(state, "bounds-checks-kept"), 1L)
+    }
+  }
+
+  test("bound that is not tied to the array keeps its check") {
+    val code =
+      """
+      fn sum(arr: IntArray, i: Int, n: Int, acc: Int): Int =
+        if i < n then sum arr (i + 1) n (acc + ar_int_get arr i)
+        else acc
+        end
+      ;
+      fn main(): Unit =
+        let arr = ar_int_new 10;
+        println (int_to_str (sum arr 0 20 0))
+      ;
+      """
+
+    compileState(code).map { state =>
+      val names = calledNames("sum", state.module)
+      assert(names.contains("ar_int_get"), s"Expected checked get, got: $names")
+    }
+  }
+
+  test("public functions get no parameter facts") {
+    val code =
+      """
+      pub fn sum(arr: IntArray, i: Int, n: Int, acc: Int): Int =
+        if i < n then sum arr (i + 1) n (acc + ar_int_get arr i)
+        else acc
+        end
+      ;
+      """
+
+    compileState(code).map { state =>
+      val names = calledNames("sum", state.module)
+      assert(names.contains("ar_int_get"), s"Expected checked get, got: $names")
+    }
+  }
@@ -0,0 +1,99 @@
+package mml.mmlclib.semantic
+
+import mml.mmlclib.ast.*
+import mml.mmlclib.semantic.lookupNames
+import mml.mmlclib.test.BaseEffFunSuite
+import mml.mmlclib.test.TestExtractors.*
+import mml.mmlclib.util.prettyprint.ast.prettyPrintAst
+import munit.*
+
+class ConcatChainLoweringTests extends BaseEffFunSuite:
+
+  private def bindingTerms(name: String, m: Module): List[Term] =
+    lookupNames(name, m).headOption match
+      case Some(bnd: Bnd) => bnd.value.terms
+      case other => fail(s"Expected binding `$name`, got: $other")
+
+  test("chain of three ++ is lowered to a single string builder") {
+    val code =
+      """
+      let s = "a" ++ "bc" ++ "def";
+      """
+
+    semNotFailed(code).map { m =>
+      bindingTerms("s", m) match
+        case TXApp(finalize, _, List(Expr(_, List(appended), _, _))) :: Nil =>
+          assertEquals(finalize.name, "string_builder_finalize")
+
+          def appends(term: Term, acc: List[String]): (Term, List[String]) =
+            term match
+              case TXApp(
+                    ref,
+                    _,
+                    List(Expr(_, List(sb), _, _), Expr(_, List(LiteralString(_, v, _, _)), _, _))
+                  ) if ref.name == "string_builder_append" =>
+                appends(sb, v :: acc)
+              case other => (other, acc)
+
+          val (base, values) = appends(appended, Nil)
+          assertEquals(values, List("a", "bc", "def"))
+          base match
+            case TXApp(ref, _, List(Expr(_, List(LiteralInt(_, capacity, _, _)), _, _))) =>
+              assertEquals(ref.name, "string_builder_new")
+              assertEquals(capacity, 6)
+            case other =>
+              fail(s"Expected string_builder_new, got: ${prettyPrintAst(other, 0, false, false)}")
+        case other =>
+          fail(s"Expected lowered chain, got: ${other.map(prettyPrintAst(_, 0, false, false))}")
+    }
+  }
+
+  test("single ++ keeps the concat operator") {
+    val code =
+      """
+      let s = "a" ++ "b";
+      """
+
+    semNotFailed(code).map { m =>
+      bindingTerms("s", m) match
+        case TXApp(ref, _, List(_, _)) :: Nil =>
+          assertEquals(ref.name, "++")
+        case other =>
+          fail(s"Expected ++ application, got: ${other.map(prettyPrintAst(_, 0, false, false))}")
+    }
+  }
+
+  /** Names passed to `__free_String` anywhere under `term`, in tree order. */
+  private def freedStrings(term: Term): List[String] =
+    val here = term match
+      case TXApp(ref, _, List(Expr(_, List(arg: Ref), _, _))) if ref.name == "__free_String" =>
+        List(arg.name)
+      case _ => Nil
+    val children = term match
+      case App(_, fn, arg, _, _) => freedStrings(fn) ++ arg.terms.flatMap(freedStrings)
+      case Expr(_, terms, _, _) => terms.flatMap(freedStrings)
+      case Lambda(_, _, body, _, _, _, _) => body.terms.flatMap(freedStrings)
+      case TermGroup(_, inner, _) => inner.terms.flatMap(freedStrings)
+      case Cond(_, cond, ifTrue, ifFalse, _, _) =>
+        List(cond, ifTrue, ifFalse).flatMap(_.terms.flatMap(freedStrings))
+      case _ => Nil
+    here ++ children
+
+  test("lowered chain with allocating operands frees each temporary once") {
+    val code =
+      """
+      fn label(n: Int): String = "n=" ++ int_to_str n ++ "!";
+      fn main(): Unit = println (label 3 ++ " " ++ label 4);
+      """
+
+    semNotFailed(code).map { m =>
+      val label = bindingTerms("label", m).flatMap(freedStrings)
+      val main  = bindingTerms("main", m).flatMap(freedStrings)
+
+      // label: the int_to_str operand; its own result is returned to the caller.
+      assertEquals(label.size, 1, s"label frees: $label")
+      // main: both label operands and the finalized string passed to println.
+      assertEquals(main.size, 3, s"main frees: $main")
+      assert((label ++ main).forall(_.startsWith("__tmp_")), s"frees: ${label ++ main}")
+    }
+  }
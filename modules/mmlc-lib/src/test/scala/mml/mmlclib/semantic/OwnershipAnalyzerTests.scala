@@ -1,5 +1,7 @@
 package mml.mmlclib.semantic
 
+import cats.effect.IO
+import mml.mmlclib.api.FrontEndApi
 import mml.mmlclib.ast.*
 import mml.mmlclib.test.BaseEffFunSuite
 
@@ -843,3 +845,351 @@ class OwnershipAnalyzerTests extends BaseEffFunSuite:
       )
     }
   }
+
+  test("moving the parent of a substring view that is still used is rejected") {
+    val code =
+      """
+        fn consume(~s: String): Unit = println s;
+
+        fn main(): Unit =
+          let s = "hello" ++ " world";
+          let v = substring_view s 0 5;
+          consume s;
+          println v
+        ;
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewOutlivesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewOutlivesParent error, got: ${result.errors}")
+      assertEquals(errors.head.ref.name, "s")
+      assertEquals(errors.head.view, "v")
+    }
+  }
+
+  test("substring view used before its parent moves is accepted") {
+    val code =
+      """
+        fn consume(~s: String): Unit = println s;
+
+        fn main(): Unit =
+          let s = "hello" ++ " world";
+          let v = substring_view s 6 5;
+          println v;
+          consume s
+        ;
+      """
+
+    semState(code).map { result =>
+      assert(result.errors.isEmpty, s"Expected no errors but got: ${result.errors}")
+    }
+  }
+
+  test("substring view of a temporary is rejected") {
+    val code =
+      """
+        fn main(): Unit = println (substring_view (int_to_str 12345) 0 2);
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewOfTemporary => e }
+      assert(errors.nonEmpty, s"Expected ViewOfTemporary error, got: ${result.errors}")
+    }
+  }
+
+  test("substring view returned from heap-returning function is rejected") {
+    val code =
+      """
+        fn head(s: String): String =
+          let v = substring_view s 0 1;
+          v
+        ;
+        fn main(): Unit = println "ok";
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewEscapesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewEscapesParent error, got: ${result.errors}")
+      assertEquals(errors.head.parent, "s")
+    }
+  }
+
+  test("substring view call returned from a function is rejected") {
+    val code =
+      """
+        fn head(s: String): String = substring_view s 0 1;
+        fn main(): Unit = println (head "hello");
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewEscapesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewEscapesParent error, got: ${result.errors}")
+      assertEquals(errors.head.parent, "s")
+    }
+  }
+
+  test("substring view returned past the end of its parent's scope is rejected") {
+    val code =
+      """
+        fn digits(n: Int): String =
+          let s = int_to_str n;
+          let v = substring_view s 0 2;
+          v
+        ;
+        fn main(): Unit = println (digits 12345);
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewEscapesParent => e }
+      assertEquals(errors.size, 1, s"Expected one ViewEscapesParent error, got: ${result.errors}")
+      assertEquals(errors.head.parent, "s")
+    }
+  }
+
+  test("substring view stored in a struct field is rejected") {
+    val code =
+      """
+        struct Person { name: String, age: Int };
+
+        fn main(): Unit =
+          let s = "ada " ++ "lovelace";
+          let p = Person (substring_view s 0 3) 36;
+          println s
+        ;
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewEscapesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewEscapesParent error, got: ${result.errors}")
+      assertEquals(errors.head.parent, "s")
+    }
+  }
+
+  test("substring view binding stored in a struct field is rejected") {
+    val code =
+      """
+        struct Person { name: String, age: Int };
+
+        fn main(): Unit =
+          let s = "ada " ++ "lovelace";
+          let v = substring_view s 0 3;
+          let p = Person v 36;
+          println s
+        ;
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewEscapesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewEscapesParent error, got: ${result.errors}")
+      assertEquals(errors.head.parent, "s")
+    }
+  }
+
+  test("substring view used only inside its parent's scope is accepted") {
+    val code =
+      """
+        fn first_is(s: String, c: String): Bool = str_eq (substring_view s 0 1) c;
+        fn main(): Unit =
+          let s = int_to_str 12345;
+          let v = substring_view s 1 2;
+          if first_is v "2" then println v end
+        ;
+      """
+
+    semState(code).map { result =>
+      assert(result.errors.isEmpty, s"Expected no errors but got: ${result.errors}")
+    }
+  }
+
+  test("mapped file view outliving its MappedFile is rejected") {
+    val code =
+      """
+        fn consume(~m: MappedFile): Unit = ();
+        fn main(): Unit =
+          let m = mmap_file "data.txt";
+          let text = mapped_as_string m;
+          consume m;
+          println text
+        ;
+      """
+
+    semState(code).map { result =>
+      val errors = result.errors.collect { case e: SemanticError.ViewOutlivesParent => e }
+      assert(errors.nonEmpty, s"Expected ViewOutlivesParent error, got: ${result.errors}")
+      assertEquals(errors.head.view, "text")
+    }
+  }
+
+  private def cloneCounter(source: String, name: String): IO[Long] =
+    FrontEndApi.compile(source, "Test").value.map {
+      case Right(state) if state.errors.isEmpty =>
+        state.counters
+          .find(c => c.stage == "semantic" && c.name == name)
+          .map(_.value)
+          .getOrElse(0L)
+      case Right(state) => fail(s"Compilation failed: ${state.errors}")
+      case Left(error) => fail(s"Compilation failed: $error")
+    }
+
+  private def mainBody(module: Module): Term =
+    module.members.collectFirst {
+      case b: Bnd if b.name == "main" =>
+        b.value.terms.collectFirst { case l: Lambda => l.body }.get
+    }.get
+
+  private def containsCloneIntArray(term: Term): Boolean =
+    existsTerm(term) {
+      case RefNamed(name) if name == "clone_IntArray" || name == "__clone_IntArray" => true
+    }
+
+  test("clone on the last use of an owned array becomes a move") {
+    val code =
+      """
+        fn consume(~a: IntArray): Unit = println (int_to_str (ar_int_len a));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          consume (clone_IntArray arr)
+        ;
+      """
+
+    for
+      module <- semNotFailed(code)
+      elided <- cloneCounter(code, "clones-elided")
+    yield
+      assert(!containsCloneIntArray(mainBody(module)), "last-use clone should be elided")
+      assertEquals(elided, 1L)
+  }
+
+  test("clone is kept when the original is used afterwards") {
+    val code =
+      """
+        fn consume(~a: IntArray): Unit = println (int_to_str (ar_int_len a));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          consume (clone_IntArray arr);
+          println (int_to_str (ar_int_len arr))
+        ;
+      """
+
+    for
+      module    <- semNotFailed(code)
+      remaining <- cloneCounter(code, "clones:main")
+    yield
+      assert(containsCloneIntArray(mainBody(module)), "clone before a later use must stay")
+      assertEquals(remaining, 1L)
+  }
+
+  test("clone bound to a new name is kept") {
+    val code =
+      """
+        fn main(): Unit =
+          let arr  = ar_int_new 1000;
+          let copy = clone_IntArray arr;
+          println (int_to_str (ar_int_len copy))
+        ;
+      """
+
+    semNotFailed(code).map { module =>
+      assert(containsCloneIntArray(mainBody(module)), "let-bound clone must not alias")
+    }
+  }
+
+  test("clone after earlier reads of the original becomes a move") {
+    val code =
+      """
+        fn consume(~a: IntArray): Unit = println (int_to_str (ar_int_len a));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          println (int_to_str (ar_int_len arr));
+          println (int_to_str (ar_int_sum arr));
+          consume (clone_IntArray arr)
+        ;
+      """
+
+    for
+      module <- semNotFailed(code)
+      elided <- cloneCounter(code, "clones-elided")
+    yield
+      assert(!containsCloneIntArray(mainBody(module)), "clone after the reads should be elided")
+      assertEquals(elided, 1L)
+  }
+
+  test("clone is kept when the same call also reads the original") {
+    val code =
+      """
+        fn both(~a: IntArray, b: IntArray): Unit = println (int_to_str (ar_int_len b));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          both (clone_IntArray arr) arr
+        ;
+      """
+
+    semNotFailed(code).map { module =>
+      assert(containsCloneIntArray(mainBody(module)), "clone next to a borrow must stay")
+    }
+  }
+
+  test("clone on the last use in one branch becomes a move in that branch") {
+    val code =
+      """
+        fn consume(~a: IntArray): Unit = println (int_to_str (ar_int_len a));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          if (ar_int_len arr) > 10 then consume (clone_IntArray arr)
+          else println (int_to_str (ar_int_len arr))
+          end
+        ;
+      """
+
+    for
+      module <- semNotFailed(code)
+      elided <- cloneCounter(code, "clones-elided")
+    yield
+      assert(!containsCloneIntArray(mainBody(module)), "branch-local last use should be elided")
+      assertEquals(elided, 1L)
+  }
+
+  test("clone in a branch is kept when the original is used after the conditional") {
+    val code =
+      """
+        fn consume(~a: IntArray): Unit = println (int_to_str (ar_int_len a));
+
+        fn main(): Unit =
+          let arr = ar_int_new 1000;
+          if (ar_int_len arr) > 10 then consume (clone_IntArray arr)
+          else println "short"
+          end;
+          println (int_to_str (ar_int_len arr))
+        ;
+      """
+
+    semNotFailed(code).map { module =>
+      assert(containsCloneIntArray(mainBody(module)), "clone before a later use must stay")
+    }
+  }
+
+  test("hash map is freed at scope end and borrows its keys") {
+    val code =
+      """
+        fn main(): Unit =
+          let counts = smap_new ();
+          let key    = "k" ++ (int_to_str 1);
+          smap_add counts key 1;
+          println key
+        ;
+      """
+
+    semNotFailed(code).map { module =>
+      val body = mainBody(module)
+      assert(
+        existsTerm(body) { case RefNamed(name) if name == "__free_StringMap" => true },
+        "expected the StringMap to be freed"
+      )
+      assert(countFreesOf("key", body) == 1, "key should be freed once by its owner")
+    }
+  }
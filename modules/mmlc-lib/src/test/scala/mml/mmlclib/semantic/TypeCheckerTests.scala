@@ -426,6 +426,21 @@ class TypeCheckerTests extends BaseEffFunSuite:
     }
   }
 
+  test("field selection on String emits InvalidSelection") {
+    val code =
+      """
+        fn len(s: String): Int = s.length;
+        fn ptr(s: String): CharPtr = s.data;
+      """
+
+    semState(code).map { result =>
+      val selected = result.errors.collect {
+        case SemanticError.TypeCheckingError(TypeError.InvalidSelection(ref, _, _)) => ref.name
+      }
+      assertEquals(selected.sorted, List("data", "length"))
+    }
+  }
+
   test("struct selection with unknown field emits UnknownField") {
     val code =
       """
@@ -23,7 +23,10 @@ object CommandLineConfig:
       optLevel:        Int            = 3,
       emitScopedAlias: Boolean        = false,
       targetType:      String         = "exe",
-      asan:            Boolean        = false
+      asan:            Boolean        = false,
+      singleClang:     Boolean        = false,
+      profileOut:      Option[Path]   = None,
+      runtimeStats:    Boolean        = false
     )
     case Run(
       file:            Option[Path]   = None,
@@ -40,22 +43,27 @@ object CommandLineConfig:
       printPhases:     Boolean        = false,
       optLevel:        Int            = 3,
       emitScopedAlias: Boolean        = false,
-      asan:            Boolean        = false
+      asan:            Boolean        = false,
+      singleClang:     Boolean        = false,
+      profileOut:      Option[Path]   = None,
+      runtimeStats:    Boolean        = false
     )
     case Ast(
-      file:      Option[Path] = None,
-      outputDir: String       = "build",
-      verbose:   Boolean      = false,
-      timings:   Boolean      = false,
-      noTco:     Boolean      = false
+      file:       Option[Path] = None,
+      outputDir:  String       = "build",
+      verbose:    Boolean      = false,
+      timings:    Boolean      = false,
+      noTco:      Boolean      = false,
+      profileOut: Option[Path] = None
     )
     case Ir(
-      file:      Option[Path] = None,
-      outputDir: String       = "build",
-      outputAst: Boolean      = false,
-      verbose:   Boolean      = false,
-      timings:   Boolean      = false,
-      noTco:     Boolean      = false
+      file:       Option[Path] = None,
+      outputDir:  String       = "build",
+      outputAst:  Boolean      = false,
+      verbose:    Boolean      = false,
+      timings:    Boolean      = false,
+      noTco:      Boolean      = false,
+      profileOut: Option[Path] = None
     )
     case Clean(
       outputDir: String = "build"
@@ -109,7 +117,7 @@ object CommandLineConfig:
       .text("Disable tail-call optimization")
 
     val timingOpt = opt[Unit]('m', "metrics")
-      .text("Print compilation metrics (timings, parser stats)")
+      .text("Print compilation metrics (timings, parser and bounds-check stats)")
 
     val printPhasesOpt = opt[Unit]('p', "print-phases")
       .text("Print detailed compilation phase information")
@@ -127,6 +135,15 @@ object CommandLineConfig:
     val asanOpt = opt[Unit]('s', "asan")
       .text("Enable AddressSanitizer for memory error detection")
 
+    val singleClangOpt = opt[Unit]("single-clang")
+      .text("Pipe the IR into one clang + lld LTO invocation instead of separate LLVM tools")
+
+    val profileOutOpt = opt[String]("profile-out")
+      .text("Write phase timings and counters as JSON (Chrome trace-event format) to <file>")
+
+    val runtimeStatsOpt = opt[Unit]("runtime-stats")
+      .text("Build the runtime with allocation, clone and I/O counters, printed at exit")
+
     val targetTypeOpt = opt[String]('x', "target-type")
       .validate(t =>
         if t == "exe" || t == "lib" then success
@@ -235,6 +252,24 @@ object CommandLineConfig:
         case _ => c
     )
 
+    def topLevelSingleClangOpt = singleClangOpt.action((_, c) =>
+      c.command match
+        case b: Command.Build => c.copy(command = b.copy(singleClang = true))
+        case _ => c
+    )
+
+    def topLevelProfileOutOpt = profileOutOpt.action((f, c) =>
+      c.command match
+        case b: Command.Build => c.copy(command = b.copy(profileOut = Some(Paths.get(f))))
+        case _ => c
+    )
+
+    def topLevelRuntimeStatsOpt = runtimeStatsOpt.action((_, c) =>
+      c.command match
+        case b: Command.Build => c.copy(command = b.copy(runtimeStats = true))
+        case _ => c
+    )
+
     // Run command (compile and execute)
     val runCommand =
       cmd("run")
@@ -330,6 +365,24 @@ object CommandLineConfig:
               case run: Command.Run => run.copy(asan = true)
               case cmd => cmd
             })
+          ),
+          singleClangOpt.action((_, config) =>
+            config.copy(command = config.command match {
+              case run: Command.Run => run.copy(singleClang = true)
+              case cmd => cmd
+            })
+          ),
+          profileOutOpt.action((file, config) =>
+            config.copy(command = config.command match {
+              case run: Command.Run => run.copy(profileOut = Some(Paths.get(file)))
+              case cmd => cmd
+            })
+          ),
+          runtimeStatsOpt.action((_, config) =>
+            config.copy(command = config.command match {
+              case run: Command.Run => run.copy(runtimeStats = true)
+              case cmd => cmd
+            })
           )
         )
 
@@ -368,6 +421,12 @@ object CommandLineConfig:
               case ast: Command.Ast => ast.copy(noTco = true)
               case cmd => cmd
             })
+          ),
+          profileOutOpt.action((file, config) =>
+            config.copy(command = config.command match {
+              case ast: Command.Ast => ast.copy(profileOut = Some(Paths.get(file)))
+              case cmd => cmd
+            })
           )
         )
 
@@ -412,6 +471,12 @@ object CommandLineConfig:
               case ir: Command.Ir => ir.copy(noTco = true)
               case cmd => cmd
             })
+          ),
+          profileOutOpt.action((file, config) =>
+            config.copy(command = config.command match {
+              case ir: Command.Ir => ir.copy(profileOut = Some(Paths.get(file)))
+              case cmd => cmd
+            })
           )
         )
 
@@ -502,6 +567,9 @@ object CommandLineConfig:
       topLevelOptLevelOpt,
       topLevelEmitScopedAliasOpt,
       topLevelAsanOpt,
+      topLevelSingleClangOpt,
+      topLevelProfileOutOpt,
+      topLevelRuntimeStatsOpt,
       // Subcommands (override the default Build when matched)
       runCommand,
       astCommand,
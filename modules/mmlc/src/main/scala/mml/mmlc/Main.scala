@@ -40,7 +40,10 @@ object Main extends IOApp:
                     build.printPhases,
                     build.optLevel,
                     build.emitScopedAlias,
-                    build.asan
+                    build.asan,
+                    build.singleClang,
+                    build.profileOut,
+                    build.runtimeStats
                   )
                 else
                   CompilerConfig.exe(
@@ -57,7 +60,10 @@ object Main extends IOApp:
                     build.printPhases,
                     build.optLevel,
                     build.emitScopedAlias,
-                    build.asan
+                    build.asan,
+                    build.singleClang,
+                    build.profileOut,
+                    build.runtimeStats
                   )
               CompilerApi.processNative(path, cfg)
             }
@@ -80,7 +86,10 @@ object Main extends IOApp:
                 run.printPhases,
                 run.optLevel,
                 run.emitScopedAlias,
-                run.asan
+                run.asan,
+                run.singleClang,
+                run.profileOut,
+                run.runtimeStats
               )
               CompilerApi.processRun(path, cfg)
             }
@@ -89,7 +98,13 @@ object Main extends IOApp:
             ast.file.fold(
               IO.println("Error: Source file is required for ast command").as(ExitCode(1))
             ) { path =>
-              val cfg = CompilerConfig.ast(ast.outputDir, ast.verbose, ast.timings, ast.noTco)
+              val cfg = CompilerConfig.ast(
+                ast.outputDir,
+                ast.verbose,
+                ast.timings,
+                ast.noTco,
+                ast.profileOut
+              )
               CompilerApi.processAstOnly(path, cfg)
             }
 
@@ -97,8 +112,14 @@ object Main extends IOApp:
             ir.file.fold(
               IO.println("Error: Source file is required for ir command").as(ExitCode(1))
             ) { path =>
-              val cfg =
-                CompilerConfig.ir(ir.outputDir, ir.verbose, ir.timings, ir.outputAst, ir.noTco)
+              val cfg = CompilerConfig.ir(
+                ir.outputDir,
+                ir.verbose,
+                ir.timings,
+                ir.outputAst,
+                ir.noTco,
+                ir.profileOut
+              )
               CompilerApi.processIrOnly(path, cfg)
             }
 
@@ -23,9 +23,14 @@ progress() { printf "%s\n" "$1"; }
 
 ASAN_OPTS="detect_leaks=1:halt_on_error=1:abort_on_error=1"
 
+# Tests run with a fixed pool size so the parallel runtime paths are exercised on
+# single-CPU machines too.
+MML_THREADS=4
+
 usage() {
   echo "Usage: $0 [all]"
   echo "  Runs memory tests in one ASan+LSan pass (single compile + single run per test)."
+  echo "  A test with a <name>.out file next to it must also print exactly that."
   exit 1
 }
 
@@ -80,7 +85,10 @@ run_mem() {
       continue
     fi
 
-    if ASAN_OPTIONS="$ASAN_OPTS" "$binary" > /dev/null 2>&1; then
+    expected="$TESTS_DIR/$name.out"
+    actual="$BUILD_DIR/$name.actual"
+    if ASAN_OPTIONS="$ASAN_OPTS" MML_THREADS="$MML_THREADS" "$binary" > "$actual" 2> /dev/null &&
+      { [ ! -f "$expected" ] || diff -u "$expected" "$actual"; }; then
       run_end=$(date +%s)
       run_elapsed=$((run_end - run_start))
       progress "[mem] ($current/$total) ran $name (${run_elapsed}s)"